@@ -3,16 +3,42 @@
 
 #include <vector>
 
+#include "fixed_vector.h"
+#include "log.h"
+#include "rng.h"
 #include "role.h"
 
 class GameState; // forward declarations
-class Action;
+struct Action;
 
+// Upper bound on the legal Actions of a single position: up to 200 Mayor allocations (see MayorAction::get_legal_actions)
+// plus the Actions of every other Role when choosing a Role
+constexpr int MAX_LEGAL_ACTIONS = 320;
+using MoveList = FixedVector<Action, MAX_LEGAL_ACTIONS>;
+
+// Every Role also implements `template <typename Log> void perform(GameState& game, const Action& action) const`,
+// explicitly instantiated for NullLog and ConsoleLog in its .cpp file (member templates can't be virtual)
 class ActionBase {
     public:
         ~ActionBase() = default;
-        virtual void perform(GameState& game, const Action& action) const = 0; // TODO: take this Action argument away
-        virtual std::vector<Action> get_legal_actions(const GameState& game, bool bonus = false) const = 0;
+        // Appends the legal Actions to the end of the list
+        virtual void get_legal_actions(const GameState& game, MoveList& actions, bool bonus = false) const = 0;
+        // Same as the size of the list get_legal_actions() appends, and its k-th element, without generating the whole list
+        virtual int count_legal_actions(const GameState& game, bool bonus = false) const = 0;
+        virtual Action nth_legal_action(const GameState& game, int k, bool bonus = false) const = 0;
+        // A uniformly random legal Action in a single pass, or an Action of type NONE if there are none
+        virtual Action random_legal_action(const GameState& game, Rng& rng, bool bonus = false) const = 0;
+};
+
+// The legal Action queries of a Role that lists its Actions in a private generate_actions(game, bonus, sink) template,
+// see action_sink.h. Instantiated in the Role's .cpp file, where generate_actions() is defined.
+template <typename Role>
+class ActionGenerator : public ActionBase {
+public:
+    void get_legal_actions(const GameState& game, MoveList& actions, bool bonus = false) const override;
+    int count_legal_actions(const GameState& game, bool bonus = false) const override;
+    Action nth_legal_action(const GameState& game, int k, bool bonus = false) const override;
+    Action random_legal_action(const GameState& game, Rng& rng, bool bonus = false) const override;
 };
 
 #endif // ACTION_H
\ No newline at end of file
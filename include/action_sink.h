@@ -0,0 +1,80 @@
+#ifndef ACTION_SINK_H
+#define ACTION_SINK_H
+
+#include "game.h"
+
+#include <stdexcept>
+
+// Each Role generates its legal Actions in one place, a function template in its .cpp file that passes them one by one
+// to a sink, in the order get_legal_actions() lists them. The sinks below turn that single generator into
+// get_legal_actions(), count_legal_actions(), nth_legal_action() and random_legal_action(), so counting or picking
+// an Action needs no MoveList. ActionGenerator below implements all four once for every Role.
+
+struct ActionAppender {
+    MoveList& actions;
+    void operator()(const Action& action) { actions.push_back(action); }
+};
+
+struct ActionCounter {
+    int count = 0;
+    void operator()(const Action&) { count++; }
+};
+
+struct NthActionFinder {
+    int k;
+    int idx = 0;
+    Action action;
+
+    explicit NthActionFinder(int k) : k(k) {}
+    void operator()(const Action& candidate) {
+        if (idx++ == k)
+            action = candidate;
+    }
+
+    Action result() const {
+        if (k < 0 || k >= idx)
+            throw std::runtime_error("Legal Action index out of range");
+        return action;
+    }
+};
+
+// Reservoir sampling: every Action seen so far is the picked one with equal probability
+struct RandomActionPicker {
+    Rng& rng;
+    std::uint32_t seen = 0;
+    Action action;
+
+    void operator()(const Action& candidate) {
+        if (rng() % ++seen == 0)
+            action = candidate;
+    }
+};
+
+template <typename Role>
+void ActionGenerator<Role>::get_legal_actions(const GameState& game, MoveList& actions, bool bonus) const {
+    ActionAppender appender{actions};
+    static_cast<const Role&>(*this).generate_actions(game, bonus, appender);
+}
+
+template <typename Role>
+int ActionGenerator<Role>::count_legal_actions(const GameState& game, bool bonus) const {
+    ActionCounter counter;
+    static_cast<const Role&>(*this).generate_actions(game, bonus, counter);
+    return counter.count;
+}
+
+template <typename Role>
+Action ActionGenerator<Role>::nth_legal_action(const GameState& game, int k, bool bonus) const {
+    NthActionFinder finder(k);
+    static_cast<const Role&>(*this).generate_actions(game, bonus, finder);
+    return finder.result();
+}
+
+template <typename Role>
+Action ActionGenerator<Role>::random_legal_action(const GameState& game, Rng& rng, bool bonus) const {
+    RandomActionPicker picker{rng};
+    static_cast<const Role&>(*this).generate_actions(game, bonus, picker);
+    return picker.action;
+}
+
+#endif // ACTION_SINK_H
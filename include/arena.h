@@ -0,0 +1,74 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator handing out objects from large contiguous blocks.
+// Nothing is freed individually: reset() releases everything at once in O(1) and keeps the blocks for reuse,
+// so after the first few uses an Arena doesn't touch the heap at all. Destructors are never run,
+// which is why only trivially destructible types can be allocated.
+class Arena {
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::size_t block_size;
+    std::size_t block_idx = 0; // block currently being filled
+    std::size_t offset = 0; // first free byte in it
+    std::size_t used = 0;
+    std::size_t peak = 0;
+
+    void* allocate_bytes(std::size_t size, std::size_t alignment) {
+        if (size > block_size)
+            throw std::invalid_argument("Arena allocation larger than its block size");
+
+        offset = (offset + alignment - 1) / alignment * alignment;
+        if (block_idx == blocks.size() || offset + size > block_size) {
+            if (block_idx < blocks.size())
+                block_idx++; // current block is full, move on to the next one
+            if (block_idx == blocks.size())
+                blocks.emplace_back(new char[block_size]);
+            offset = 0;
+        }
+
+        void* ptr = blocks[block_idx].get() + offset;
+        offset += size;
+        used += size;
+        peak = std::max(peak, used);
+        return ptr;
+    }
+
+public:
+    explicit Arena(std::size_t block_size = 1 << 20) : block_size(block_size) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // Constructs count consecutive objects, each from the same arguments
+    template <typename T, typename... Args>
+    T* create_array(std::size_t count, const Args&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "Arena never runs destructors");
+
+        T* array = static_cast<T*>(allocate_bytes(count * sizeof(T), alignof(T)));
+        for (std::size_t i = 0; i < count; i++)
+            new (array + i) T(args...);
+        return array;
+    }
+
+    template <typename T, typename... Args>
+    T* create(const Args&... args) { return create_array<T>(1, args...); }
+
+    void reset() {
+        block_idx = 0;
+        offset = 0;
+        used = 0;
+    }
+
+    std::size_t bytes_used() const { return used; } // since the last reset()
+    std::size_t peak_bytes() const { return peak; } // over the Arena's lifetime
+    std::size_t bytes_reserved() const { return blocks.size() * block_size; }
+};
+
+#endif // ARENA_H
@@ -10,9 +10,13 @@
 class BasicHeuristic : public StateEvaluator {
 public:
     std::vector<double> evaluate(const GameState &state) override;
+    void evaluate(const GameState &state, Scores &scores) override;
     double building_value(BuildingType type) const;
     double building_score(const Building& building) const;
     int evaluate(const PlayerState &state);
+    // Score of the player to move after the action, which is tried on the game with perform_action() and undo_action(),
+    // so the game is left as it was
+    int evaluate_move(GameState &game, const Action &action);
 };
 
 #endif // BASIC_HEURISTIC_H
@@ -3,10 +3,17 @@
 
 #include "action.h"
 
-class BuilderAction : public ActionBase {
+class BuilderAction : public ActionGenerator<BuilderAction> {
 public:
-    void perform(GameState& game, const Action& action) const override;
-    std::vector<Action> get_legal_actions(const GameState& game, bool is_builder = false) const override;
+    template <typename Log>
+    void perform(GameState& game, const Action& action) const;
+
+private:
+    friend class ActionGenerator<BuilderAction>;
+    template <typename Sink>
+    void generate_actions(const GameState& game, bool is_builder, Sink& sink) const;
 };
 
+extern template class ActionGenerator<BuilderAction>;
+
 #endif // Builder_H
\ No newline at end of file
@@ -3,9 +3,10 @@
 
 #include "good.h"
 
+#include <cstdint>
 #include <vector>
 
-enum class BuildingType {
+enum class BuildingType : std::uint8_t {
     SMALL_INDIGO_PLANT = 0,
     SMALL_SUGAR_MILL = 1,
     SMALL_MARKET = 2,
@@ -109,7 +110,6 @@ struct Building {
 
     Building() : type(BuildingType::NONE) {}
     Building(BuildingType type) : type(type) {}
-    Building(const Building& other) : type(other.type) {}
 
     int cost() const { return BuildingCosts[static_cast<int>(type)]; }
     int victory_points() const { return BuildingVPs[static_cast<int>(type)]; }
@@ -120,6 +120,42 @@ struct Building {
     std::string name() const { return building_name(type); }
 
     bool operator<(const Building& other) const { return type < other.type; } // for std::set
+    bool operator==(const Building& other) const { return type == other.type; }
+};
+
+// Set of BuildingTypes packed into 23 bits, stored as 3 bytes so it doesn't force 4-byte alignment on Action
+struct BuildingMask {
+    std::uint8_t bits[3] = {0, 0, 0};
+
+    bool contains(BuildingType type) const {
+        int idx = static_cast<int>(type);
+        return bits[idx / 8] & (1u << (idx % 8));
+    }
+
+    void insert(BuildingType type) {
+        int idx = static_cast<int>(type);
+        bits[idx / 8] |= static_cast<std::uint8_t>(1u << (idx % 8));
+    }
+
+    void erase(BuildingType type) {
+        int idx = static_cast<int>(type);
+        bits[idx / 8] &= static_cast<std::uint8_t>(~(1u << (idx % 8)));
+    }
+
+    int size() const {
+        int count = 0;
+        for (unsigned byte : bits)
+            for (; byte; byte &= byte - 1)
+                count++;
+        return count;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    bool operator==(const BuildingMask& other) const {
+        return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+    }
+    bool operator!=(const BuildingMask& other) const { return !(*this == other); }
 };
 
 #endif // BULDING_H
\ No newline at end of file
@@ -3,10 +3,17 @@
 
 #include "action.h"
 
-class CaptainAction : public ActionBase {
+class CaptainAction : public ActionGenerator<CaptainAction> {
 public:
-    void perform(GameState& game, const Action& action) const override;
-    std::vector<Action> get_legal_actions(const GameState& game, bool is_captain = false) const override;
+    template <typename Log>
+    void perform(GameState& game, const Action& action) const;
+
+private:
+    friend class ActionGenerator<CaptainAction>;
+    template <typename Sink>
+    void generate_actions(const GameState& game, bool is_captain, Sink& sink) const;
 };
 
+extern template class ActionGenerator<CaptainAction>;
+
 #endif // CAPTAIN_H
\ No newline at end of file
@@ -3,10 +3,17 @@
 
 #include "action.h"
 
-class CraftsmanAction : public ActionBase {
+class CraftsmanAction : public ActionGenerator<CraftsmanAction> {
 public:
-    void perform(GameState& game, const Action& action) const override;
-    std::vector<Action> get_legal_actions(const GameState& game, bool is_craftsman = false) const override;
+    template <typename Log>
+    void perform(GameState& game, const Action& action) const;
+
+private:
+    friend class ActionGenerator<CraftsmanAction>;
+    template <typename Sink>
+    void generate_actions(const GameState& game, bool is_craftsman, Sink& sink) const;
 };
 
+extern template class ActionGenerator<CraftsmanAction>;
+
 #endif // CRAFTSMAN_H
\ No newline at end of file
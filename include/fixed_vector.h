@@ -0,0 +1,118 @@
+#ifndef FIXED_VECTOR_H
+#define FIXED_VECTOR_H
+
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Vector-like container with inline storage for at most N elements.
+// Unlike std::vector it never allocates, and it is trivially copyable whenever T is,
+// so a GameState built out of these can be copied with a single memcpy.
+template <typename T, int N>
+class FixedVector {
+    using size_type_ = std::conditional_t<(N < 256), std::uint8_t, std::uint16_t>;
+
+    T data_[N];
+    size_type_ size_ = 0;
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    FixedVector() = default;
+    FixedVector(std::initializer_list<T> init) { insert(end(), init.begin(), init.end()); }
+
+    FixedVector& operator=(std::initializer_list<T> init) {
+        clear();
+        insert(end(), init.begin(), init.end());
+        return *this;
+    }
+
+    iterator begin() { return data_; }
+    iterator end() { return data_ + size_; }
+    const_iterator begin() const { return data_; }
+    const_iterator end() const { return data_ + size_; }
+
+    T& operator[](std::size_t idx) { return data_[idx]; }
+    const T& operator[](std::size_t idx) const { return data_[idx]; }
+    T& front() { return data_[0]; }
+    const T& front() const { return data_[0]; }
+    T& back() { return data_[size_ - 1]; }
+    const T& back() const { return data_[size_ - 1]; }
+
+    std::size_t size() const { return size_; }
+    static constexpr std::size_t capacity() { return N; }
+    bool empty() const { return size_ == 0; }
+    bool full() const { return size_ == N; }
+
+    void clear() { size_ = 0; }
+    void reserve(std::size_t) {} // storage is inline, kept for std::vector compatibility
+
+    void resize(std::size_t count, const T& value = T()) {
+        if (count > std::size_t(N))
+            throw std::runtime_error("FixedVector capacity exceeded");
+        for (std::size_t i = size_; i < count; i++)
+            data_[i] = value;
+        size_ = static_cast<size_type_>(count);
+    }
+
+    void push_back(const T& value) {
+        if (size_ == N)
+            throw std::runtime_error("FixedVector capacity exceeded");
+        data_[size_++] = value;
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == N)
+            throw std::runtime_error("FixedVector capacity exceeded");
+        data_[size_] = T{std::forward<Args>(args)...};
+        return data_[size_++];
+    }
+
+    void pop_back() { size_--; }
+
+    bool operator==(const FixedVector& other) const {
+        return size_ == other.size_ && std::equal(begin(), end(), other.begin());
+    }
+    bool operator!=(const FixedVector& other) const { return !(*this == other); }
+
+    iterator erase(iterator pos) {
+        std::move(pos + 1, end(), pos);
+        size_--;
+        return pos;
+    }
+
+    iterator erase(iterator first, iterator last) {
+        std::move(last, end(), first);
+        size_ -= static_cast<size_type_>(last - first);
+        return first;
+    }
+
+    iterator insert(iterator pos, std::size_t count, const T& value) {
+        if (size_ + count > std::size_t(N))
+            throw std::runtime_error("FixedVector capacity exceeded");
+        std::move_backward(pos, end(), end() + count);
+        std::fill(pos, pos + count, value);
+        size_ += static_cast<size_type_>(count);
+        return pos;
+    }
+
+    template <typename InputIt>
+    iterator insert(iterator pos, InputIt first, InputIt last) {
+        std::size_t count = std::distance(first, last);
+        if (size_ + count > std::size_t(N))
+            throw std::runtime_error("FixedVector capacity exceeded");
+        std::move_backward(pos, end(), end() + count);
+        std::copy(first, last, pos);
+        size_ += static_cast<size_type_>(count);
+        return pos;
+    }
+};
+
+#endif // FIXED_VECTOR_H
@@ -3,8 +3,11 @@
 
 #include "action.h"
 #include "building.h"
+#include "fixed_vector.h"
 #include "good.h"
+#include "rng.h"
 #include "roles.h"
+#include "zobrist.h"
 
 #include <iostream>
 #include <vector>
@@ -12,10 +15,11 @@
 #include <algorithm>
 #include <random>
 #include <set>
+#include <type_traits>
 
 class GameStateIntegrityChecker; // forward declaration
 
-enum class Plantation {
+enum class Plantation : std::uint8_t {
     CORN = 0,
     INDIGO = 1,
     SUGAR = 2,
@@ -37,7 +41,9 @@ inline const std::string PlantationNames[] = {
 
 struct PlantationState {
     Plantation plantation;
-    int colonists;
+    std::int16_t colonists;
+
+    bool operator==(const PlantationState& other) const { return plantation == other.plantation && colonists == other.colonists; }
 };
 
 inline std::string plantation_name(Plantation plantation) { return PlantationNames[static_cast<int>(plantation)]; }
@@ -45,14 +51,18 @@ inline std::string plantation_name(PlantationState ps) { return plantation_name(
 
 struct BuildingState {
     Building building;
-    int colonists;
+    std::int16_t colonists;
+
+    bool operator==(const BuildingState& other) const { return building == other.building && colonists == other.colonists; }
 };
 
 // TODO: consider adding to_string() methods, or overloading << operator instead of x_name(x) methods
 
 struct BuildingSupply {
     Building building;
-    int count;
+    std::int8_t count;
+
+    bool operator==(const BuildingSupply& other) const { return building == other.building && count == other.count; }
 };
 
 struct GoodSupply {
@@ -63,29 +73,44 @@ struct GoodSupply {
 struct RoleState {
     PlayerRole role;
     bool taken = false;
-    int doubloons = 0;
+    std::int16_t doubloons = 0;
+
+    bool operator==(const RoleState& other) const { return role == other.role && taken == other.taken && doubloons == other.doubloons; }
 };
 
 // TODO: also use for Craftsman
 struct ProductionDistribution {
-    int w[6] = {0, 0, 0, 0, 0, 0}; // corn, indigo, sugar, tobacco, coffee, querry;
-
-    int& corn() { return w[0]; }
-    int& indigo() { return w[1]; }
-    int& sugar() { return w[2]; }
-    int& tobacco() { return w[3]; }
-    int& coffee() { return w[4]; }
-    int& querry() { return w[5]; }
+    std::int8_t w[6] = {0, 0, 0, 0, 0, 0}; // corn, indigo, sugar, tobacco, coffee, querry;
+
+    ProductionDistribution() = default;
+    ProductionDistribution(int corn, int indigo, int sugar, int tobacco, int coffee, int querry)
+        : w{static_cast<std::int8_t>(corn), static_cast<std::int8_t>(indigo), static_cast<std::int8_t>(sugar),
+            static_cast<std::int8_t>(tobacco), static_cast<std::int8_t>(coffee), static_cast<std::int8_t>(querry)} {}
+
+    std::int8_t& corn() { return w[0]; }
+    std::int8_t& indigo() { return w[1]; }
+    std::int8_t& sugar() { return w[2]; }
+    std::int8_t& tobacco() { return w[3]; }
+    std::int8_t& coffee() { return w[4]; }
+    std::int8_t& querry() { return w[5]; }
+    int corn() const { return w[0]; }
+    int indigo() const { return w[1]; }
+    int sugar() const { return w[2]; }
+    int tobacco() const { return w[3]; }
+    int coffee() const { return w[4]; }
+    int querry() const { return w[5]; }
+
+    bool operator==(const ProductionDistribution& other) const { return std::equal(w, w + 6, other.w); }
 };
 
 struct MayorAllocation {
     ProductionDistribution distribution;
-    std::vector<BuildingType> buildings;
-    int extra_colonists = 0;
+    BuildingMask buildings; // occupied non-production buildings
+    std::int8_t extra_colonists = 0;
 
     MayorAllocation() = default;
-    MayorAllocation(ProductionDistribution distribution, std::vector<BuildingType> buildings, int extra_colonists) 
-        : distribution(distribution), buildings(buildings), extra_colonists(extra_colonists) {}
+    MayorAllocation(ProductionDistribution distribution, BuildingMask buildings, int extra_colonists)
+        : distribution(distribution), buildings(buildings), extra_colonists(static_cast<std::int8_t>(extra_colonists)) {}
 
     int colonists() const {
         int total_colonists = buildings.size() + distribution.w[0] + distribution.w[5];
@@ -93,23 +118,25 @@ struct MayorAllocation {
             total_colonists += 2 * distribution.w[i];
         return total_colonists + extra_colonists;
     }
+
+    bool operator==(const MayorAllocation& other) const {
+        return distribution == other.distribution && buildings == other.buildings && extra_colonists == other.extra_colonists;
+    }
 };
 
 struct PlayerState {
-    const int idx;
+    std::int16_t idx = 0;
 
-    int doubloons;
-    int victory_points = 0;
-    int extra_colonists = 0;
-    int goods[5] = {0, 0, 0, 0, 0};
-    std::vector<PlantationState> plantations;
-    std::vector<BuildingState> buildings;
-    int free_town_space = 12;
+    std::int16_t doubloons = 0;
+    std::int16_t victory_points = 0;
+    std::int16_t extra_colonists = 0;
+    std::int16_t goods[5] = {0, 0, 0, 0, 0};
+    FixedVector<PlantationState, 12> plantations;
+    FixedVector<BuildingState, 12> buildings;
+    std::int16_t free_town_space = 12;
 
+    PlayerState() = default;
     PlayerState(int player_count, int player_idx) : idx(player_idx) {
-        plantations.reserve(12);
-        buildings.reserve(12);
-
         doubloons = player_count - 1; // 3/4/5 players start with 2/3/4 doubloons
 
         // Starting plantation:
@@ -132,6 +159,12 @@ struct PlayerState {
         }
     }
 
+    bool operator==(const PlayerState& other) const {
+        return idx == other.idx && doubloons == other.doubloons && victory_points == other.victory_points
+            && extra_colonists == other.extra_colonists && std::equal(goods, goods + 5, other.goods)
+            && plantations == other.plantations && buildings == other.buildings && free_town_space == other.free_town_space;
+    }
+
     bool has(Building building, bool check_colonist = true) const {
         return std::find_if(buildings.begin(), buildings.end(), [building, check_colonist](const BuildingState& building_state) {
             return building_state.building.type == building.type && (!check_colonist || building_state.colonists > 0);
@@ -212,8 +245,8 @@ struct PlayerState {
     }
 
     // TODO: don't use GoodSupply here, it's kinda dumb
-    std::vector<GoodSupply> get_producing_goods(bool theoretical_maximum = false) const {
-        std::vector<GoodSupply> producing_goods;
+    FixedVector<GoodSupply, 5> get_producing_goods(bool theoretical_maximum = false) const {
+        FixedVector<GoodSupply, 5> producing_goods;
 
         int plantation_production[5] = {0, 0, 0, 0, 0};
         int building_production[5] = {12, 0, 0, 0, 0}; // Corn doesn't need a building
@@ -276,12 +309,20 @@ struct PlayerState {
 struct Ship {
     static const int WHARF_CAPACITY = 100;
 
-    int capacity;
+    std::int16_t capacity;
     Good good;
-    int good_count;
-    int owner = -1;
+    std::int16_t good_count;
+    std::int16_t owner = -1;
+
+    Ship() = default;
+    Ship(int capacity, Good good, int good_count, int owner = -1)
+        : capacity(capacity), good(good), good_count(good_count), owner(owner) {}
 
     bool is_wharf() const { return owner != -1; }
+
+    bool operator==(const Ship& other) const {
+        return capacity == other.capacity && good == other.good && good_count == other.good_count && owner == other.owner;
+    }
 };
 
 enum RuleSet {
@@ -290,28 +331,32 @@ enum RuleSet {
     // EXPANSION // extra buildings
 };
 
+// Packed into 16 bytes without any heap storage, so Actions are cheap to copy, compare and keep in search trees.
+// Every field is a single byte; only the fields used by the Action's Role are meaningful.
 struct Action {
-    // TODO: it would be good if this class were smaller memory-wise - std::variant and switch case, std::get_if<BuilderAction>, etc.
     PlayerRole type;
 
     Building building = BuildingType::NONE;
     Plantation plantation = Plantation::NONE;
-    int building_cost = 0;
     Good good = Good::NONE;
-    int ship_capacity = 0;
-    int sell_price = 0;
-    MayorAllocation mayor_allocation;
+    union { // no Role uses both
+        std::int8_t building_cost = 0; // Builder, also the Hacienda flag for Settler
+        std::int8_t sell_price; // Trader, also the Captain bonus
+    };
+    std::int8_t ship_capacity = 0;
+    MayorAllocation mayor_allocation; // Mayor, also the kept Goods when storing after the Captain phase
 
     Action() : type(PlayerRole::NONE) {}
     Action(PlayerRole type) : type(type) {}
-    Action(Building building, int cost) : type(PlayerRole::BUILDER), building(building), building_cost(cost) {}
+    Action(Building building, int cost) : type(PlayerRole::BUILDER), building(building), building_cost(static_cast<std::int8_t>(cost)) {}
     Action(Plantation plantation, bool hacienda = false) : type(PlayerRole::SETTLER), plantation(plantation), building_cost(hacienda) {}
     Action(Good good) : type(PlayerRole::CRAFTSMAN), good(good) {}
-    Action(Good good, int price) : type(PlayerRole::TRADER), good(good), sell_price(price) {}
+    Action(Good good, int price) : type(PlayerRole::TRADER), good(good), sell_price(static_cast<std::int8_t>(price)) {}
     Action(MayorAllocation allocation) : type(PlayerRole::MAYOR), mayor_allocation(allocation) {}
-    Action(int ship_capacity, Good good, int bonus) : type(PlayerRole::CAPTAIN), good(good), ship_capacity(ship_capacity), sell_price(bonus) {}
+    Action(int ship_capacity, Good good, int bonus)
+        : type(PlayerRole::CAPTAIN), good(good), sell_price(static_cast<std::int8_t>(bonus)), ship_capacity(static_cast<std::int8_t>(ship_capacity)) {}
     Action(ProductionDistribution dist, int bonus) // for storing Goods after Captain phase
-        : type(PlayerRole::CAPTAIN), good(Good::NONE), sell_price(bonus), mayor_allocation(dist, {}, 0) {}
+        : type(PlayerRole::CAPTAIN), good(Good::NONE), sell_price(static_cast<std::int8_t>(bonus)), mayor_allocation(dist, {}, 0) {}
 
     bool operator==(const Action& other) const {
         if (type != other.type)
@@ -326,14 +371,57 @@ struct Action {
         if (type == PlayerRole::TRADER)
             return good == other.good && sell_price == other.sell_price;
         if (type == PlayerRole::MAYOR)
-            return mayor_allocation.distribution.w[0] == other.mayor_allocation.distribution.w[0];
+            return mayor_allocation == other.mayor_allocation;
         if (type == PlayerRole::CAPTAIN)
-            return good == other.good && ship_capacity == other.ship_capacity && sell_price == other.sell_price;
+            return good == other.good && ship_capacity == other.ship_capacity && sell_price == other.sell_price
+                && mayor_allocation == other.mayor_allocation;
 
         return true;
     }
 };
 
+static_assert(sizeof(Action) <= 16, "Action should stay small, it is stored in every search tree node");
+static_assert(std::is_trivially_copyable<Action>::value, "Action should not own any heap memory");
+
+// Everything GameState::perform_action() can change, saved right before the move so undo_action() can restore it.
+// The scalars, Roles and moving player are always saved, the other sections only for the Role that can modify them
+// (including its end-of-round cleanup in next_round()), so a make/undo pair costs far less than copying the GameState.
+struct UndoRecord {
+    PlayerRole type = PlayerRole::NONE;
+
+    std::uint64_t hash;
+    bool game_ending;
+    bool hacienda_just_used;
+    PlayerRole current_role;
+    Rng rng;
+    int round;
+    int governor_idx;
+    int current_round_player_idx;
+    int current_player_idx;
+    int winner;
+    int colonist_supply;
+    int colonist_ship;
+    int colonists_for_player[5];
+    int victory_points_supply;
+    int good_supply[5];
+    int quarry_supply;
+    int cant_ship_counter;
+
+    FixedVector<RoleState, 8> role_state;
+    PlayerState player; // the player making the move
+
+    std::int16_t goods[5][5]; // CRAFTSMAN - production reaches every player
+    std::int16_t doubloons[5]; // CRAFTSMAN - Factory bonus
+
+    FixedVector<BuildingSupply, 23> building_supply; // BUILDER
+    FixedVector<Ship, 5> ships; // CAPTAIN, BUILDER (Wharf)
+    FixedVector<Good, 4> trading_house; // TRADER
+
+    int plantation_supply[5]; // SETTLER
+    FixedVector<Plantation, 6> plantation_offer; // SETTLER
+    int plantation_discard[5]; // SETTLER
+};
+
 struct GameState {
     // Puerto Rico board state for 3-5 players
 
@@ -343,7 +431,7 @@ struct GameState {
     bool game_ending = false;
 
     int seed;
-    std::mt19937 rng;
+    Rng rng;
 
     // TODO: seperate these members into classes, e.g. PlayerManager, RoleManager, SupplyManager, etc.
 
@@ -352,9 +440,9 @@ struct GameState {
     int current_round_player_idx = 0;
     int current_player_idx = 0;
     int winner = -1;
-    std::vector<int> player_placements;
+    FixedVector<int, 5> player_placements;
     PlayerRole current_role = PlayerRole::NONE;
-    std::vector<RoleState> role_state;
+    FixedVector<RoleState, 8> role_state;
 
     int colonist_supply;
     int colonist_ship;
@@ -364,18 +452,20 @@ struct GameState {
     int good_supply[5] = {0, 0, 0, 0, 0};
 
     int quarry_supply = 8;
-    std::vector<Plantation> plantation_supply;
-    std::vector<Plantation> plantation_offer;
-    std::vector<Plantation> plantation_discard;
+    int plantation_supply[5] = {0, 0, 0, 0, 0}; // face-down tiles left of each type (Quarries are in quarry_supply)
+    FixedVector<Plantation, 6> plantation_offer;
+    int plantation_discard[5] = {0, 0, 0, 0, 0};
     bool hacienda_just_used = false;
 
-    std::vector<BuildingSupply> building_supply;
+    FixedVector<BuildingSupply, 23> building_supply;
     
     int cant_ship_counter = 0; // for knowing when to end the Captain phase
-    std::vector<Ship> ships;
-    std::vector<Good> trading_house;
+    FixedVector<Ship, 5> ships; // 3 public ships + up to 2 Wharfs
+    FixedVector<Good, 4> trading_house;
+
+    FixedVector<PlayerState, 5> player_state;
 
-    std::vector<PlayerState> player_state;
+    std::uint64_t hash = 0; // Zobrist hash of everything above except the rng, seed, round and placements - see set()
 public:
     // TODO: make Config struct with all parameters (there will be even more of them in the future)
     GameState(int player_count, bool verbose = false, int seed = std::random_device()()) 
@@ -410,28 +500,22 @@ public:
         good_supply[3] = 9;
         good_supply[4] = 9;
 
-        int corn_count = (player_count == 3) ? 9 : 8;
-        int indigo_count = (player_count < 5) ? 10 : 9;
-
-        plantation_supply.insert(plantation_supply.end(), corn_count, Plantation::CORN);
-        plantation_supply.insert(plantation_supply.end(), indigo_count, Plantation::INDIGO);
-        plantation_supply.insert(plantation_supply.end(), 11, Plantation::SUGAR);
-        plantation_supply.insert(plantation_supply.end(), 9, Plantation::TOBACCO);
-        plantation_supply.insert(plantation_supply.end(), 8, Plantation::COFFEE);
+        plantation_supply[0] = (player_count == 3) ? 9 : 8;
+        plantation_supply[1] = (player_count < 5) ? 10 : 9;
+        plantation_supply[2] = 11;
+        plantation_supply[3] = 9;
+        plantation_supply[4] = 8;
 
-        std::shuffle(plantation_supply.begin(), plantation_supply.end(), rng);
-
-        // move last 4/5/6 plantations from supply to plantation_offer
+        // draw 4/5/6 plantations from supply to plantation_offer
         for (int i = 0; i < player_count + 1; i++) {
-            plantation_offer.push_back(plantation_supply.back());
-            plantation_supply.pop_back();
+            plantation_offer.push_back(draw_plantation());
         }
 
         building_supply.reserve(23);
         for (int i = 0; i < static_cast<int>(BuildingType::NONE); i++) {
             auto type = static_cast<BuildingType>(i);
             auto building = Building(type);
-            building_supply.push_back({building, building.starting_global_supply()});
+            building_supply.push_back({building, static_cast<std::int8_t>(building.starting_global_supply())});
         }
 
         ships = {
@@ -446,145 +530,231 @@ public:
         for (int player_idx = 0; player_idx < player_count; player_idx++) {
             player_state.emplace_back(player_count, player_idx);
         }
+
+        hash = compute_hash();
     }
 
     ~GameState() = default;
 
-    std::vector<Action> get_legal_actions() const {
+    // Appends the legal Actions to the end of the list - reuse one MoveList to generate moves without touching the heap
+    void get_legal_actions(MoveList& actions) const {
         if (current_role == PlayerRole::NONE) {
-            std::vector<Action> actions;
-
             for (const auto& role : role_state) {
-                if (role.taken)
-                    continue;
-
-                // TODO: generalize this and save 20 lines of code
-
-                if (role.role == PlayerRole::PROSPECTOR) {
-                    auto legal_actions = ProspectorAction().get_legal_actions(*this, true);
-                    actions.insert(actions.end(), legal_actions.begin(), legal_actions.end());
-                }
-                else if (role.role == PlayerRole::PROSPECTOR_2) {
-                    auto legal_actions = Prospector2Action().get_legal_actions(*this, true);
-                    actions.insert(actions.end(), legal_actions.begin(), legal_actions.end());
-                }
-                else if (role.role == PlayerRole::BUILDER) {
-                    auto build_actions = BuilderAction().get_legal_actions(*this, true);
-                    actions.insert(actions.end(), build_actions.begin(), build_actions.end());
-                }
-                else if (role.role == PlayerRole::SETTLER) {
-                    auto legal_actions = SettlerAction().get_legal_actions(*this, true);
-                    actions.insert(actions.end(), legal_actions.begin(), legal_actions.end());
-                }
-                else if (role.role == PlayerRole::CRAFTSMAN) {
-                    auto craftsman_actions = CraftsmanAction().get_legal_actions(*this, true);
-                    actions.insert(actions.end(), craftsman_actions.begin(), craftsman_actions.end());
-                }
-                else if (role.role == PlayerRole::TRADER) {
-                    auto legal_actions = TraderAction().get_legal_actions(*this, true);
-                    actions.insert(actions.end(), legal_actions.begin(), legal_actions.end());
-                }
-                else if (role.role == PlayerRole::MAYOR) {
-                    auto mayor_actions = MayorAction().get_legal_actions(*this, true);
-                    actions.insert(actions.end(), mayor_actions.begin(), mayor_actions.end());
-                }
-                else if (role.role == PlayerRole::CAPTAIN) {
-                    auto legal_actions = CaptainAction().get_legal_actions(*this, true);
-                    actions.insert(actions.end(), legal_actions.begin(), legal_actions.end());
-                }
+                if (!role.taken)
+                    role_handler(role.role).get_legal_actions(*this, actions, true);
             }
-
-            return actions;
         }
-        else if (current_role == PlayerRole::BUILDER) {
-            return BuilderAction().get_legal_actions(*this);
+        else if (current_role == PlayerRole::CRAFTSMAN || current_role == PlayerRole::PROSPECTOR || current_role == PlayerRole::PROSPECTOR_2) {
+            // deliberately ommited - they are one-player Roles that trigger instantly
+            throw std::runtime_error("Role Not implemented - cannot choose action");
         }
-        else if (current_role == PlayerRole::SETTLER) {
-            return SettlerAction().get_legal_actions(*this);
+        else {
+            role_handler(current_role).get_legal_actions(*this, actions, false);
         }
-        else if (current_role == PlayerRole::TRADER) {
-            return TraderAction().get_legal_actions(*this);
-        }
-        else if (current_role == PlayerRole::MAYOR) {
-            return MayorAction().get_legal_actions(*this);
+    }
+
+    // Same as the size of get_legal_actions() and its k-th Action, without generating the list
+    int count_legal_actions() const {
+        if (current_role != PlayerRole::NONE)
+            return role_handler(current_role).count_legal_actions(*this, false);
+
+        int count = 0;
+        for (const auto& role : role_state) {
+            if (!role.taken)
+                count += role_handler(role.role).count_legal_actions(*this, true);
         }
-        else if (current_role == PlayerRole::CAPTAIN) {
-            return CaptainAction().get_legal_actions(*this);
+        return count;
+    }
+
+    Action nth_legal_action(int k) const {
+        if (current_role != PlayerRole::NONE)
+            return role_handler(current_role).nth_legal_action(*this, k, false);
+
+        for (const auto& role : role_state) {
+            if (role.taken)
+                continue;
+            int count = role_handler(role.role).count_legal_actions(*this, true);
+            if (k < count)
+                return role_handler(role.role).nth_legal_action(*this, k, true);
+            k -= count;
         }
-        // CRAFTSMAN, PROSPECTOR, PROSPECTOR_2 deliberately ommited - they are one-player Roles that trigger instantly
+        throw std::runtime_error("Legal Action index out of range");
+    }
 
-        throw std::runtime_error("Role Not implemented - cannot choose action");
+    std::vector<Action> get_legal_actions() const {
+        MoveList actions;
+        get_legal_actions(actions);
+        return std::vector<Action>(actions.begin(), actions.end());
     }
 
+    // Plays a move for good, printing the game if it's verbose. Searches and rollouts call perform_action<NullLog>() directly.
     void perform_action(const Action& action) {
+        if (verbose)
+            perform_action<ConsoleLog, false>(action);
+        else
+            perform_action<NullLog, false>(action);
+    }
+
+    // Undoable = false saves no UndoRecord, for moves that are never undone like those of rollouts
+    template <typename Log, bool Undoable = true>
+    std::conditional_t<Undoable, UndoRecord, void> perform_action(const Action& action) {
         if (action.type == PlayerRole::NONE)
             throw std::runtime_error("Cannot perform action of type NONE");
 
-        current_role = action.type;
+        if constexpr (Undoable) {
+            UndoRecord undo = save_undo(action.type);
+            apply_action<Log>(action);
+            return undo;
+        } else {
+            apply_action<Log>(action);
+        }
+    }
+
+    template <typename Log>
+    void apply_action(const Action& action) {
+        set(current_role, action.type);
 
         auto& player = player_state[current_player_idx];
         int role_idx = static_cast<int>(action.type);
         auto& role = role_state[role_idx];
 
-        if (verbose && player.idx == current_round_player_idx
-            && !(role.role == PlayerRole::SETTLER && hacienda_just_used)
-            && !(role.role == PlayerRole::CAPTAIN && action.sell_price == 0)
-        ) {
-            std::cout << "Player "  << player.idx << " chose role: " << role_name(action.type) << std::endl;
-            if (role.doubloons > 0)
-                std::cout << "Player " << player.idx << " got " << role.doubloons << " extra doubloons" << std::endl;
+        if constexpr (Log::enabled) {
+            if (player.idx == current_round_player_idx
+                && !(role.role == PlayerRole::SETTLER && hacienda_just_used)
+                && !(role.role == PlayerRole::CAPTAIN && action.sell_price == 0)
+            ) {
+                Log::out() << "Player "  << player.idx << " chose role: " << role_name(action.type) << '\n';
+                if (role.doubloons > 0)
+                    Log::out() << "Player " << player.idx << " got " << role.doubloons << " extra doubloons" << '\n';
+            }
         }
 
-        role.taken = true;
-        player.doubloons += role.doubloons;
-        role.doubloons = 0;
+        set(role.taken, true);
+        add(player.doubloons, role.doubloons);
+        set(role.doubloons, 0);
+
+        role_handler<Log>(action.type).perform(*this, action);
+    }
 
-        // TODO: dyanmically dispatch .perform() call
-        if (action.type == PlayerRole::PROSPECTOR) {
-            ProspectorAction().perform(*this, action);
+    UndoRecord save_undo(PlayerRole type) const {
+        UndoRecord undo;
+        undo.type = type;
+
+        undo.hash = hash;
+        undo.game_ending = game_ending;
+        undo.hacienda_just_used = hacienda_just_used;
+        undo.current_role = current_role;
+        undo.rng = rng;
+        undo.round = round;
+        undo.governor_idx = governor_idx;
+        undo.current_round_player_idx = current_round_player_idx;
+        undo.current_player_idx = current_player_idx;
+        undo.winner = winner;
+        undo.colonist_supply = colonist_supply;
+        undo.colonist_ship = colonist_ship;
+        std::copy(colonists_for_player, colonists_for_player + 5, undo.colonists_for_player);
+        undo.victory_points_supply = victory_points_supply;
+        std::copy(good_supply, good_supply + 5, undo.good_supply);
+        undo.quarry_supply = quarry_supply;
+        undo.cant_ship_counter = cant_ship_counter;
+
+        undo.role_state = role_state;
+        undo.player = player_state[current_player_idx];
+
+        if (type == PlayerRole::CRAFTSMAN) {
+            for (int i = 0; i < player_count; i++) {
+                std::copy(player_state[i].goods, player_state[i].goods + 5, undo.goods[i]);
+                undo.doubloons[i] = player_state[i].doubloons;
+            }
+        }
+        else if (type == PlayerRole::BUILDER) {
+            undo.building_supply = building_supply;
+            undo.ships = ships;
         }
-        else if (action.type == PlayerRole::PROSPECTOR_2) {
-            Prospector2Action().perform(*this, action);
+        else if (type == PlayerRole::CAPTAIN) {
+            undo.ships = ships;
         }
-        else if (action.type == PlayerRole::CRAFTSMAN) {
-            CraftsmanAction().perform(*this, action);
+        else if (type == PlayerRole::TRADER) {
+            undo.trading_house = trading_house;
         }
-        else if (action.type == PlayerRole::BUILDER) {
-            BuilderAction().perform(*this, action);
+        else if (type == PlayerRole::SETTLER) {
+            std::copy(plantation_supply, plantation_supply + 5, undo.plantation_supply);
+            undo.plantation_offer = plantation_offer;
+            std::copy(plantation_discard, plantation_discard + 5, undo.plantation_discard);
+        }
+
+        return undo;
+    }
+
+    void undo_action(const UndoRecord& undo) {
+        hash = undo.hash;
+        game_ending = undo.game_ending;
+        hacienda_just_used = undo.hacienda_just_used;
+        current_role = undo.current_role;
+        rng = undo.rng;
+        round = undo.round;
+        governor_idx = undo.governor_idx;
+        current_round_player_idx = undo.current_round_player_idx;
+        current_player_idx = undo.current_player_idx;
+        colonist_supply = undo.colonist_supply;
+        colonist_ship = undo.colonist_ship;
+        std::copy(undo.colonists_for_player, undo.colonists_for_player + 5, colonists_for_player);
+        victory_points_supply = undo.victory_points_supply;
+        std::copy(undo.good_supply, undo.good_supply + 5, good_supply);
+        quarry_supply = undo.quarry_supply;
+        cant_ship_counter = undo.cant_ship_counter;
+
+        if (undo.winner == -1)
+            player_placements.clear(); // placements only exist once determine_winner() ran
+        winner = undo.winner;
+
+        role_state = undo.role_state;
+
+        if (undo.type == PlayerRole::CRAFTSMAN) {
+            for (int i = 0; i < player_count; i++) {
+                std::copy(undo.goods[i], undo.goods[i] + 5, player_state[i].goods);
+                player_state[i].doubloons = undo.doubloons[i];
+            }
         }
-        else if (action.type == PlayerRole::SETTLER) {
-            SettlerAction().perform(*this, action);
+        else if (undo.type == PlayerRole::BUILDER) {
+            building_supply = undo.building_supply;
+            ships = undo.ships;
         }
-        else if (action.type == PlayerRole::TRADER) {
-            TraderAction().perform(*this, action);
+        else if (undo.type == PlayerRole::CAPTAIN) {
+            ships = undo.ships;
         }
-        else if (action.type == PlayerRole::MAYOR) {
-            MayorAction().perform(*this, action);
+        else if (undo.type == PlayerRole::TRADER) {
+            trading_house = undo.trading_house;
         }
-        else if (action.type == PlayerRole::CAPTAIN) {
-            CaptainAction().perform(*this, action);
+        else if (undo.type == PlayerRole::SETTLER) {
+            std::copy(undo.plantation_supply, undo.plantation_supply + 5, plantation_supply);
+            plantation_offer = undo.plantation_offer;
+            std::copy(undo.plantation_discard, undo.plantation_discard + 5, plantation_discard);
         }
 
-        return;
+        player_state[current_player_idx] = undo.player;
     }
 
+    template <typename Log>
     void next_governor() {
         // next player becomes Governor, all roles are available
-        governor_idx = (governor_idx + 1) % player_count;
-        current_round_player_idx = governor_idx;
-        current_player_idx = governor_idx;
+        set(governor_idx, (governor_idx + 1) % player_count);
+        set(current_round_player_idx, governor_idx);
+        set(current_player_idx, governor_idx);
         round++;
 
-        if (verbose && !game_ending)
-            std::cout << "Player " << governor_idx << " is now the Governor" << std::endl;
+        if constexpr (Log::enabled) {
+            if (!game_ending)
+                Log::out() << "Player " << governor_idx << " is now the Governor" << '\n';
+        }
 
         // reset role state
         for (auto& role : role_state) {
             if (role.taken) {
-                role.taken = false;
+                set(role.taken, false);
             }
             else {
-                role.doubloons += 1;
+                add(role.doubloons, 1);
             }
         }
 
@@ -593,30 +763,36 @@ public:
         }
     }
 
+    template <typename Log>
     void next_round() {
         // next player has to choose a role
 
         if (current_role == PlayerRole::SETTLER) {
             // refill plantation offer
 
-            plantation_discard.insert(plantation_discard.end(), plantation_offer.begin(), plantation_offer.end());
+            hash -= key(plantation_offer);
+
+            for (auto plantation : plantation_offer)
+                add(plantation_discard[static_cast<int>(plantation)], 1);
             plantation_offer.clear();
 
-            while (plantation_supply.size() > 0 && plantation_offer.size() < std::size_t(player_count + 1)) {
-                plantation_offer.push_back(plantation_supply.back());
-                plantation_supply.pop_back();
+            while (plantation_supply_count() > 0 && plantation_offer.size() < std::size_t(player_count + 1)) {
+                plantation_offer.push_back(draw_plantation());
             }
 
-            if (plantation_supply.size() == 0) {
-                plantation_supply.insert(plantation_supply.end(), plantation_discard.begin(), plantation_discard.end());
-                plantation_discard.clear();
-                std::shuffle(plantation_supply.begin(), plantation_supply.end(), rng);
+            if (plantation_supply_count() == 0) {
+                // the discarded tiles become the new supply - no need to shuffle, tiles are drawn at random
+                for (int i = 0; i < 5; i++) {
+                    add(plantation_supply[i], plantation_discard[i]);
+                    set(plantation_discard[i], 0);
+                }
             }
 
-            while (plantation_supply.size() > 0 && plantation_offer.size() < std::size_t(player_count + 1)) {
-                plantation_offer.push_back(plantation_supply.back());
-                plantation_supply.pop_back();
+            while (plantation_supply_count() > 0 && plantation_offer.size() < std::size_t(player_count + 1)) {
+                plantation_offer.push_back(draw_plantation());
             }
+
+            hash += key(plantation_offer);
         }
         else if (current_role == PlayerRole::MAYOR) {
             // refill colonist ship
@@ -629,67 +805,84 @@ public:
 
             int next_colonist_ship = std::max(empty_building_slots, player_count);
             if (next_colonist_ship > colonist_supply)
-                trigger_game_end("Not enough Colonists available to fill the Colonist Ship");
+                trigger_game_end<Log>("Not enough Colonists available to fill the Colonist Ship");
             
-            colonist_ship = std::min(next_colonist_ship, colonist_supply);
-            colonist_supply -= colonist_ship;
+            set(colonist_ship, std::min(next_colonist_ship, colonist_supply));
+            add(colonist_supply, -colonist_ship);
 
-            if (verbose)
-                std::cout << "Colonist Ship refilled with " << colonist_ship << " colonists. Remaining colonist supply: " << colonist_supply << std::endl;
+            if constexpr (Log::enabled)
+                Log::out() << "Colonist Ship refilled with " << colonist_ship << " colonists. Remaining colonist supply: " << colonist_supply << '\n';
         }
         else if (current_role == PlayerRole::TRADER) {
             // clear trading house
 
             if (trading_house.size() == 4) {
                 for (const auto& good : trading_house) {
-                    good_supply[static_cast<int>(good)] += 1;
+                    add(good_supply[static_cast<int>(good)], 1);
                 }
+                hash -= key(trading_house);
                 trading_house.clear();
 
-                if (verbose)
-                    std::cout << "Trading House is full! Goods cleared and returned to supply" << std::endl;
+                if constexpr (Log::enabled)
+                    Log::out() << "Trading House is full! Goods cleared and returned to supply" << '\n';
             }
         }
         else if (current_role == PlayerRole::CAPTAIN) {
             // clear full ships
 
-            cant_ship_counter = 0;
+            set(cant_ship_counter, 0);
             for (auto& ship : ships) {
                 if (ship.good_count == ship.capacity || (ship.is_wharf() && ship.good_count > 0)) { // always clear Wharf
                     int gidx = static_cast<int>(ship.good);
-                    good_supply[gidx] += ship.good_count;
-                    ship.good_count = 0;
-                    ship.good = Good::NONE;
+                    add(good_supply[gidx], ship.good_count);
+                    set(ship.good_count, 0);
+                    set(ship.good, Good::NONE);
 
-                    if (verbose)
-                        std::cout << "Ship of size " << ship.capacity << " is full! Goods cleared and returned to supply" << std::endl;
+                    if constexpr (Log::enabled)
+                        Log::out() << "Ship of size " << ship.capacity << " is full! Goods cleared and returned to supply" << '\n';
                 }
             }
         }
 
-        if (verbose)
-            std::cout << std::endl;
+        if constexpr (Log::enabled)
+            Log::out() << '\n';
 
-        current_role = PlayerRole::NONE;
-        current_round_player_idx = (current_round_player_idx + 1) % player_count;
-        current_player_idx = current_round_player_idx;
+        set(current_role, PlayerRole::NONE);
+        set(current_round_player_idx, (current_round_player_idx + 1) % player_count);
+        set(current_player_idx, current_round_player_idx);
         if (current_round_player_idx == governor_idx) {
-            next_governor();
+            next_governor<Log>();
         }
     }
 
+    template <typename Log>
     void next_player() {
         // everyone performs an Action of the currrent role
-        current_player_idx = (current_player_idx + 1) % player_count;
+        set(current_player_idx, (current_player_idx + 1) % player_count);
         if (current_role == PlayerRole::CAPTAIN) {
             if (cant_ship_counter >= player_count)
-                next_round();
+                next_round<Log>();
         }
         else if (current_player_idx == current_round_player_idx) {
-            next_round();
+            next_round<Log>();
         }
     }
 
+    int plantation_supply_count() const {
+        return plantation_supply[0] + plantation_supply[1] + plantation_supply[2] + plantation_supply[3] + plantation_supply[4];
+    }
+
+    // Removes a uniformly random tile from the (non-empty) supply - the same distribution as drawing from a shuffled deck
+    Plantation draw_plantation() {
+        int tile = rng() % plantation_supply_count();
+        int pidx = 0;
+        while (tile >= plantation_supply[pidx])
+            tile -= plantation_supply[pidx++];
+
+        add(plantation_supply[pidx], -1);
+        return static_cast<Plantation>(pidx);
+    }
+
     int get_current_player_idx() const {
         return current_player_idx;
     }
@@ -699,7 +892,6 @@ public:
     }
 
     int determine_winner() {
-        winner = 0;
 
         std::vector<std::pair<std::pair<int, int>, int>> player_scores;
 
@@ -719,19 +911,22 @@ public:
         for (int i = 0; i < player_count; i++)
             player_placements[player_scores[i].second] = i;
 
-        winner = player_scores[0].second;
+        set(winner, player_scores[0].second);
 
         return winner;
     }
 
+    template <typename Log>
     void trigger_game_end(const std::string& reason) {
-        if (verbose && !game_ending) {
-            std::cout << std::endl << "!!!!!" << std::endl;
-            std::cout << reason << " - Game will end after this round" << std::endl;
-            std::cout << "!!!!!" << std::endl << std::endl;
+        if constexpr (Log::enabled) {
+            if (!game_ending) {
+                Log::out() << '\n' << "!!!!!" << '\n';
+                Log::out() << reason << " - Game will end after this round" << '\n';
+                Log::out() << "!!!!!" << '\n' << '\n';
+            }
         }
 
-        game_ending = true;
+        set(game_ending, true);
     }
 
     void print_all(bool show_points = true) const {
@@ -783,6 +978,90 @@ public:
     }
 
     bool check_integrity() const;
+
+    // Zobrist hashing: `hash` is the sum of one key per hashed member, derived from the member's position and value.
+    // Roles must change hashed members through set()/add()/push_back()/pop_back(), or subtract the key() of a whole
+    // container before rearranging it and add it back afterwards, so that the hash stays in sync incrementally.
+
+    template <typename T>
+    std::uint64_t key(const T& field) const {
+        auto offset = reinterpret_cast<const char*>(&field) - reinterpret_cast<const char*>(this);
+        return zobrist_key(offset, static_cast<int>(field));
+    }
+    std::uint64_t key(const PlantationState& p) const { return key(p.plantation) + key(p.colonists); }
+    std::uint64_t key(const BuildingState& b) const { return key(b.building.type) + key(b.colonists); }
+    std::uint64_t key(const BuildingSupply& b) const { return key(b.count); }
+    std::uint64_t key(const RoleState& r) const { return key(r.taken) + key(r.doubloons); }
+    std::uint64_t key(const Ship& s) const { return key(s.capacity) + key(s.good) + key(s.good_count) + key(s.owner); }
+    std::uint64_t key(const PlayerState& p) const {
+        std::uint64_t h = key(p.doubloons) + key(p.victory_points) + key(p.extra_colonists) + key(p.free_town_space);
+        for (const auto& good : p.goods)
+            h += key(good);
+        return h + key(p.plantations) + key(p.buildings);
+    }
+    template <typename T, int N>
+    std::uint64_t key(const FixedVector<T, N>& v) const {
+        std::uint64_t h = 0;
+        for (const auto& element : v)
+            h += key(element);
+        return h;
+    }
+
+    template <typename T, typename V>
+    void set(T& field, V value) {
+        hash -= key(field);
+        field = static_cast<T>(value);
+        hash += key(field);
+    }
+
+    template <typename T, typename V>
+    void add(T& field, V delta) { set(field, field + delta); }
+
+    template <typename T, int N>
+    void push_back(FixedVector<T, N>& v, const T& value) {
+        v.push_back(value);
+        hash += key(v.back());
+    }
+
+    template <typename T, int N>
+    void pop_back(FixedVector<T, N>& v) {
+        hash -= key(v.back());
+        v.pop_back();
+    }
+
+    std::uint64_t compute_hash() const {
+        std::uint64_t h = key(game_ending) + key(governor_idx) + key(current_round_player_idx) + key(current_player_idx)
+            + key(winner) + key(current_role) + key(role_state) + key(colonist_supply) + key(colonist_ship)
+            + key(victory_points_supply) + key(quarry_supply) + key(plantation_offer)
+            + key(hacienda_just_used) + key(building_supply) + key(cant_ship_counter)
+            + key(ships) + key(trading_house) + key(player_state);
+        for (int i = 0; i < 5; i++)
+            h += key(colonists_for_player[i]) + key(good_supply[i]) + key(plantation_supply[i]) + key(plantation_discard[i]);
+        return h;
+    }
+
+    bool operator==(const GameState& other) const {
+        return rule_set == other.rule_set && player_count == other.player_count && verbose == other.verbose
+            && game_ending == other.game_ending && seed == other.seed && rng == other.rng
+            && round == other.round && governor_idx == other.governor_idx
+            && current_round_player_idx == other.current_round_player_idx && current_player_idx == other.current_player_idx
+            && winner == other.winner && player_placements == other.player_placements
+            && current_role == other.current_role && role_state == other.role_state
+            && colonist_supply == other.colonist_supply && colonist_ship == other.colonist_ship
+            && std::equal(colonists_for_player, colonists_for_player + 5, other.colonists_for_player)
+            && victory_points_supply == other.victory_points_supply
+            && std::equal(good_supply, good_supply + 5, other.good_supply)
+            && quarry_supply == other.quarry_supply && std::equal(plantation_supply, plantation_supply + 5, other.plantation_supply)
+            && plantation_offer == other.plantation_offer && std::equal(plantation_discard, plantation_discard + 5, other.plantation_discard)
+            && hacienda_just_used == other.hacienda_just_used && building_supply == other.building_supply
+            && cant_ship_counter == other.cant_ship_counter && ships == other.ships
+            && trading_house == other.trading_house && player_state == other.player_state && hash == other.hash;
+    }
+    bool operator!=(const GameState& other) const { return !(*this == other); }
 };
 
+// Search strategies copy GameState once per node/iteration, so it must stay a flat block of memory
+static_assert(std::is_trivially_copyable<GameState>::value, "GameState must be trivially copyable");
+static_assert(sizeof(GameState) <= 1024, "GameState grew beyond its size budget");
+
 #endif // GAME_H
\ No newline at end of file
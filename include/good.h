@@ -1,9 +1,10 @@
 #ifndef GOOD_H
 #define GOOD_H
 
+#include <cstdint>
 #include <string>
 
-enum class Good {
+enum class Good : std::uint8_t {
     CORN = 0,
     INDIGO = 1,
     SUGAR = 2,
@@ -18,6 +18,7 @@ private:
     void check_building_count() const;
     void check_plantation_count() const;
     void check_victory_points() const;
+    void check_hash() const;
 };
 
 #endif // INTEGRITY_CHECKER_H
\ No newline at end of file
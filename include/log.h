@@ -0,0 +1,22 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <iostream>
+
+// Logging policies for the game logic. GameState::perform_action() and the Roles are templated on one of these,
+// and every message is guarded by `if constexpr (Log::enabled)`, so NullLog instantiations contain no logging code at all.
+
+// For searches and rollouts
+struct NullLog {
+    static constexpr bool enabled = false;
+};
+
+// For games watched or played by humans.
+// Lines end with '\n' instead of std::endl, so std::cout is flushed by its own buffering rather than after every line.
+// (std::cin is tied to std::cout, so everything is still flushed before ConsoleStrategy waits for input.)
+struct ConsoleLog {
+    static constexpr bool enabled = true;
+    static std::ostream& out() { return std::cout; }
+};
+
+#endif // LOG_H
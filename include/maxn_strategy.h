@@ -5,35 +5,73 @@
 #include "state_evaluator.h"
 #include "basic_heuristic.h"
 #include "game.h"
+#include "transposition_table.h"
 
+#include <algorithm>
+#include <chrono>
 #include <vector>
 
 class MaxnStrategy : public Strategy {
+    using Clock = std::chrono::steady_clock;
+
     int max_depth;
+    std::chrono::milliseconds time_limit{0}; // 0 searches every move to max_depth
     StateEvaluator* evaluator;
+    TranspositionTable table;
+    std::vector<MoveList> move_lists; // one per search depth, reused so maxn() never allocates Actions
+    Clock::time_point deadline = Clock::time_point::max();
+    bool timed_out = false;
+    unsigned node_count = 0;
+    int last_depth = 0;
 public:
     struct Choice {
         Action action;
         std::vector<double> score;
     };
 
-    // TODO: we could give it a time limit and use iterative deepening to get the best move in the time limit - depth will be variable
-    
-    MaxnStrategy(int depth, StateEvaluator* evaluator = new BasicHeuristic) : max_depth(depth), evaluator(evaluator) {}
+    // table_size is the number of transposition table entries (rounded up to a power of two), 0 disables the table
+    MaxnStrategy(int depth, std::size_t table_size = 1 << 16, StateEvaluator* evaluator = new BasicHeuristic)
+        : max_depth(depth), evaluator(evaluator), table(table_size), move_lists(depth + 1) {}
+
+    // Deepens iteratively until the time limit per move runs out or max_depth is reached,
+    // then plays the best move of the deepest search that was completed. Depth 1 is always completed.
+    MaxnStrategy(std::chrono::milliseconds time_limit, int max_depth = 16, std::size_t table_size = 1 << 16,
+                 StateEvaluator* evaluator = new BasicHeuristic)
+        : MaxnStrategy(max_depth, table_size, evaluator) {
+        this->time_limit = time_limit;
+    }
     ~MaxnStrategy() override { delete evaluator; };
 
+    const TranspositionTable& transposition_table() const { return table; }
+    int depth_reached() const { return last_depth; } // depth of the last move's completed search, 0 if it had a single option
+
     void make_move(GameState& game) override {
-        bool verbose = game.verbose;
-        game.verbose = false; // don't print Actions in maxn() recursion
-        std::vector<Action> actions = game.get_legal_actions();
+        MoveList actions;
+        game.get_legal_actions(actions);
 
+        last_depth = 0;
         if (actions.size() == 1) {
             game.perform_action(actions[0]); // only one legal action, no need to evaluate
             return;
         }
 
-        Choice best_choice = maxn(game, max_depth); // TODO: make this depth configurable
-        game.verbose = verbose; // restore verbosity 
+        table.new_search();
+
+        if (time_limit.count() > 0) {
+            game.perform_action(deepen(game, actions));
+            return;
+        }
+
+        // position already searched deep enough, e.g. by the previous move's search
+        last_depth = max_depth;
+        if (const auto* entry = table.probe(game.hash, max_depth)) {
+            if (std::find(actions.begin(), actions.end(), entry->best_action) != actions.end()) {
+                game.perform_action(entry->best_action);
+                return;
+            }
+        }
+
+        Choice best_choice = search(game, max_depth);
 
         if (best_choice.action.type == PlayerRole::NONE)
             throw std::runtime_error("No legal actions - game is over");
@@ -41,33 +79,86 @@ public:
         game.perform_action(best_choice.action);
     }
 
-    Choice maxn(const GameState& state, int depth) {
+    // Iterative deepening: searches depth 1, 2, ... until the time limit runs out, keeping the result of the last complete search
+    Action deepen(const GameState& game, const MoveList& actions) {
+        Clock::time_point move_deadline = Clock::now() + time_limit;
+        Action best_action;
+
+        for (int depth = 1; depth <= max_depth; depth++) {
+            // position already searched this deep, e.g. by the previous move's search
+            if (const auto* entry = table.probe(game.hash, depth)) {
+                if (std::find(actions.begin(), actions.end(), entry->best_action) != actions.end()) {
+                    best_action = entry->best_action;
+                    last_depth = depth;
+                    continue;
+                }
+            }
+
+            deadline = depth == 1 ? Clock::time_point::max() : move_deadline;
+            timed_out = false;
+            Choice choice = search(game, depth);
+            if (timed_out)
+                break;
+
+            best_action = choice.action;
+            last_depth = depth;
+            if (Clock::now() >= move_deadline)
+                break;
+        }
+
+        if (best_action.type == PlayerRole::NONE)
+            throw std::runtime_error("No legal actions - game is over");
+        return best_action;
+    }
+
+    Choice search(const GameState& game, int depth) {
+        GameState state = game; // maxn() walks the tree in place on this copy with perform_action/undo_action
+        return maxn(state, depth);
+    }
+
+    Choice maxn(GameState& state, int depth) {
         int player_idx = state.get_current_player_idx();
 
         if (depth == 0 || state.is_game_over()) {
             Choice choice;
-            choice.score = evaluator->evaluate(state);
+            choice.score = evaluator->evaluate(state); // leaves aren't cached - a table miss costs about as much as evaluating
+            return choice;
+        }
+
+        // transposed positions (e.g. duplicate Mayor allocations) are only searched once
+        if (const auto* entry = table.probe(state.hash, depth)) {
+            Choice choice;
+            choice.score.assign(entry->score, entry->score + state.player_count);
             return choice;
         }
 
         double max_score = std::numeric_limits<int>::min();
-        std::vector<Action> actions = state.get_legal_actions();
+        MoveList& actions = move_lists[depth];
+        actions.clear();
+        state.get_legal_actions(actions);
         Choice best_choice;
 
-        for (const auto& action : actions) {
-            GameState next_state = state;
-            next_state.perform_action(action);
-            Choice choice = maxn(next_state, depth - 1);
+        for (std::size_t i = 0; i < actions.size(); i++) {
+            UndoRecord undo = state.perform_action<NullLog>(actions[i]);
+            Choice choice = maxn(state, depth - 1);
+            state.undo_action(undo);
+
+            // the clock is only read every 256 moves searched, to keep it off the hot path
+            if (timed_out || (++node_count % 256 == 0 && Clock::now() >= deadline)) {
+                timed_out = true;
+                return best_choice; // incomplete, must not end up in the table
+            }
 
             if (choice.score[player_idx] > max_score) {
                 max_score = choice.score[player_idx];
-                best_choice.action = action;
+                best_choice.action = actions[i];
                 best_choice.score = choice.score;
             }
         }
 
+        table.store(state.hash, depth, best_choice.score, best_choice.action);
         return best_choice;
     }
 };
 
-#endif // MAXN_STRATEGY_H
\ No newline at end of file
+#endif // MAXN_STRATEGY_H
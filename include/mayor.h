@@ -5,8 +5,12 @@
 
 class MayorAction : public ActionBase {
 public:
-    void perform(GameState& game, const Action& action) const override;
-    std::vector<Action> get_legal_actions(const GameState& game, bool is_mayor = false) const override;
+    template <typename Log>
+    void perform(GameState& game, const Action& action) const;
+    void get_legal_actions(const GameState& game, MoveList& actions, bool is_mayor = false) const override;
+    int count_legal_actions(const GameState& game, bool is_mayor = false) const override;
+    Action nth_legal_action(const GameState& game, int k, bool is_mayor = false) const override;
+    Action random_legal_action(const GameState& game, Rng& rng, bool is_mayor = false) const override;
 };
 
 #endif // MAYOR_H
\ No newline at end of file
@@ -1,160 +1,835 @@
 #ifndef MONTE_CARLO_STRATEGY_H
 #define MONTE_CARLO_STRATEGY_H
 
+#include "arena.h"
+#include "basic_heuristic.h"
 #include "game.h"
 #include "player.h"
+#include "rng.h"
 #include "strategy.h"
-#include "random_strategy.h"
+#include "playout_policy.h"
+#include "prior_provider.h"
+#include "state_evaluator.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <vector>
 #include <stack>
 #include <memory>
+#include <mutex>
 #include <random>
 #include <cmath>
+#include <cstring>
+#include <functional>
 #include <limits>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
 
+// Playout result for every player of the game, in [0, 1]
+using Rewards = FixedVector<double, 5>;
+
+// Tunable parameters of the search, shared by all trees of an MCTSStrategy
+struct MCTSSettings {
+    double exploration_weight = 1.41; // TODO: try changing this weight
+
+    // Progressive widening: a node visited n times admits its first widening_k * n^widening_alpha moves by prior, 0 all
+    double widening_k = 0;
+    double widening_alpha = 0.5;
+
+    double puct_weight = 1.0; // weight of the move priors in PUCT, 0 selects by UCT
+    std::shared_ptr<PriorProvider> prior_provider = std::make_shared<HeuristicPriors>();
+
+    int early_stop_interval = 32; // iterations between checks whether the root's best move can still change, 0 never
+
+    bool placement_rewards = false; // reward playouts by placement instead of win/loss
+
+    double rave_equivalence = 0; // RAVE: visits after which a child's own value counts as much as its AMAF value, 0 off
+
+    // Truncated rollouts end after rollout_plies moves or rollout_rounds governor rounds, 0 for no limit
+    int rollout_plies = 0;
+    int rollout_rounds = 0;
+    double evaluation_temperature = 2.0; // softmax over the rollout_evaluator scores of a truncated rollout
+    std::shared_ptr<StateEvaluator> rollout_evaluator = std::make_shared<BasicHeuristic>(); // shared by all threads
+
+    bool truncates(int plies, int rounds) const {
+        return (rollout_plies > 0 && plies >= rollout_plies) || (rollout_rounds > 0 && rounds >= rollout_rounds);
+    }
+
+    int admitted_children(int visits, int child_count) const {
+        if (widening_k <= 0)
+            return child_count;
+        int admitted = static_cast<int>(widening_k * std::pow(std::max(visits, 1), widening_alpha));
+        return std::max(1, std::min(admitted, child_count));
+    }
+};
+
+// Packed Actions are hashed by their bytes, which only works as long as Action has no padding
+static_assert(std::has_unique_object_representations_v<Action>, "Action must not have padding bytes");
+
+// SplitMix64 finalizer over the two words of a packed Action.
+// Equal Actions as generated by the Roles have equal bytes, since the members a Role doesn't use keep their defaults.
+inline std::uint64_t action_hash(const Action& action) {
+    static_assert(sizeof(Action) == 2 * sizeof(std::uint64_t), "action_hash expects a 16 byte Action");
+    std::uint64_t words[2];
+    std::memcpy(words, &action, sizeof(words));
+    std::uint64_t z = words[0] ^ (words[1] * 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Nodes and their move arrays live in the search's Arena, so Node must stay trivially destructible.
+// The statistics are atomics so several threads can search the same tree (MCTSParallelism::TREE);
+// the moves are written once, by the thread that expands the node, before `state` is set to EXPANDED.
+// A child is only created when the search first selects its move, taking the moves in order,
+// so the moves that are never tried cost 16 bytes each instead of a whole Node.
 class Node {
 public:
+    enum State : std::uint8_t { UNEXPANDED, EXPANDING, EXPANDED };
+
     Node(const Action& action = Action(), Node* parent = nullptr)
-        : action(action), parent(parent), wins(0), visits(0) {}
+        : action(action), parent(parent), visits(0) {}
+
+    // Only used to copy a reused subtree between searches, when no other thread is touching either node.
+    // The links to the children and the moves still point into the old tree until they are copied as well.
+    Node& operator=(const Node& other) {
+        action = other.action;
+        hash.store(other.hash.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        parent = other.parent;
+        next_sibling = other.next_sibling;
+        first_child.store(other.first_child.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        moves = other.moves;
+        priors = other.priors;
+        move_count = other.move_count;
+        prior = other.prior;
+        child_count.store(other.child_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        player = other.player;
+        for (int i = 0; i < 5; i++)
+            rewards[i].store(other.rewards[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        visits.store(other.visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        virtual_loss.store(0, std::memory_order_relaxed);
+        amaf_rewards.store(other.amaf_rewards.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        amaf_visits.store(other.amaf_visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        state.store(other.state.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
 
     Action action; // The action that led to this node
+    std::atomic<std::uint64_t> hash{0}; // GameState::hash after the action, 0 until the search first steps into this node
     Node* parent;
-    std::vector<std::unique_ptr<Node>> children;
-    double wins;
-    int visits;
-    bool expanded = false;
+    Node* next_sibling = nullptr; // the child of parent created before this one
+    std::atomic<Node*> first_child{nullptr}; // the child created last, the others follow through next_sibling
+    const Action* moves = nullptr; // legal moves without duplicates, in the order their children are created
+    const float* priors = nullptr; // PUCT: the prior of each move, nullptr without PUCT
+    int move_count = 0;
+    float prior = 1; // PUCT: the prior of the move that led to this node
+    std::atomic<int> child_count{0}; // children created from the front of moves, including ones still being linked in
+    std::int8_t player = 0; // the player to move here, set on expansion; best_child() maximizes this player's rewards
+    std::atomic<double> rewards[5]{}; // summed over the playouts through this node, one per player
+    std::atomic<int> visits;
+    std::atomic<int> virtual_loss{0}; // searches currently passing through this node, counted as lost playouts by best_child()
+    std::atomic<double> amaf_rewards{0}; // RAVE: rewards of the parent's player over the playouts in which they made this move
+    std::atomic<int> amaf_visits{0}; // below the parent, see MCTSSettings::rave_equivalence
+    std::atomic<State> state{UNEXPANDED};
 
-    // TODO: try changing this weight
-    Node* best_child(double exploration_weight = 1.41) const {
+    bool expanded() const { return state.load(std::memory_order_acquire) == EXPANDED; }
+    Node* children() const { return first_child.load(std::memory_order_acquire); }
+
+    // Best child by UCT or PUCT, nullptr if there are none yet. Stores its rating in best_value.
+    // Every player is assumed to pick the move best for themselves (max^n), so the children are rated by the mover's rewards
+    // and not by those of the player the search is for.
+    Node* best_child(const MCTSSettings& settings, double* best_value = nullptr) const {
         Node* best = nullptr;
-        double best_value = -std::numeric_limits<double>::infinity();
-        for (const auto& child : children) {
-            double uct_value = child->wins / (child->visits + 1e-6) +
-                               exploration_weight * std::sqrt(std::log(visits + 1) / (child->visits + 1e-6));
-            if (uct_value > best_value) {
-                best_value = uct_value;
-                best = child.get();
+        double best_rating = -std::numeric_limits<double>::infinity();
+        int parent_visits = visits.load(std::memory_order_relaxed);
+        double exploration_weight = settings.exploration_weight;
+        double rave_equivalence = settings.rave_equivalence;
+        double puct_scale = settings.puct_weight * std::sqrt(parent_visits);
+        for (Node* child = children(); child != nullptr; child = child->next_sibling) {
+            double child_visits = child->visits.load(std::memory_order_relaxed) + child->virtual_loss.load(std::memory_order_relaxed);
+            double value = child->rewards[player].load(std::memory_order_relaxed) / (child_visits + 1e-6);
+            int amaf_visits = child->amaf_visits.load(std::memory_order_relaxed);
+            if (rave_equivalence > 0 && amaf_visits > 0) {
+                double beta = std::sqrt(rave_equivalence / (3 * child_visits + rave_equivalence));
+                value = (1 - beta) * value + beta * child->amaf_rewards.load(std::memory_order_relaxed) / amaf_visits;
+            }
+            double exploration = settings.puct_weight > 0
+                ? puct_scale * child->prior / (1 + child_visits)
+                : exploration_weight * std::sqrt(std::log(parent_visits + 1) / (child_visits + 1e-6));
+            if (value + exploration > best_rating) {
+                best_rating = value + exploration;
+                best = child;
             }
         }
+        if (best_value != nullptr)
+            *best_value = best_rating;
         return best;
     }
 
-    Action best_action() const { //returns move with most visits
-        int best_visits = -1;
-        Action best_action;
-        for (const auto& child : children) {
-            if (child->visits > best_visits) {
-                best_visits = child->visits;
-                best_action = child->action;
-            }
+    // Mean reward of the player to move here
+    double value() const {
+        int node_visits = visits.load(std::memory_order_relaxed);
+        return node_visits == 0 ? 0.0 : rewards[player].load(std::memory_order_relaxed) / node_visits;
+    }
+
+    const Node* find_child(const Action& action) const {
+        for (const Node* child = children(); child != nullptr; child = child->next_sibling) {
+            if (child->action == action)
+                return child;
         }
-        return best_action;
+        return nullptr;
     }
 };
 
-// Monte Carlo Tree Search
-class MCTSStrategy : public Strategy {
+// The moves of one search iteration together with the player who made them, for RAVE.
+// An open addressing set on action_hash; every slot carries the iteration it was filled in,
+// so starting the next iteration doesn't need to clear the table.
+class PlayedMoves {
 public:
-    MCTSStrategy(int iterations = 1000)
-        : iterations(iterations), rng(std::random_device{}()) {}
+    void clear() {
+        iteration++;
+        count = 0;
+    }
 
-    void make_move(GameState& game) override {
-        root = new Node();
-        bool verbose = game.verbose;
-        game.verbose = false;
-        Action action = search(root, game);
-        game.verbose = verbose;
-        game.perform_action(action);
-        delete root;
+    void insert(int player, const Action& action) {
+        if (2 * (count + 1) > slots.size())
+            grow();
+        Slot& slot = slots[find(player, action)];
+        if (slot.iteration != iteration) {
+            slot = {iteration, static_cast<std::int8_t>(player), action};
+            count++;
+        }
+    }
+
+    bool contains(int player, const Action& action) const {
+        return slots[find(player, action)].iteration == iteration;
     }
 
 private:
-    int iterations;
-    int player_idx = 0;
-    Node* root;
-    std::mt19937 rng;
-    GameState* game = nullptr;
-
-    Action search(Node* root, const GameState& game) {
-        player_idx = game.get_current_player_idx();
-        for (int i = 0; i < iterations; ++i) {
+    struct Slot {
+        std::uint32_t iteration = 0;
+        std::int8_t player = 0;
+        Action action;
+    };
+
+    std::vector<Slot> slots = std::vector<Slot>(512); // size is a power of two
+    std::uint32_t iteration = 1;
+    std::size_t count = 0;
+
+    // Index of the move's slot, or of the free one where it would go
+    std::size_t find(int player, const Action& action) const {
+        std::size_t mask = slots.size() - 1;
+        std::size_t idx = (action_hash(action) + static_cast<std::uint64_t>(player) * 0x9E3779B97F4A7C15ULL) & mask;
+        while (slots[idx].iteration == iteration && !(slots[idx].player == player && slots[idx].action == action))
+            idx = (idx + 1) & mask;
+        return idx;
+    }
+
+    void grow() {
+        std::vector<Slot> old(slots.size() * 2);
+        old.swap(slots);
+        for (const Slot& slot : old) {
+            if (slot.iteration == iteration)
+                slots[find(slot.player, slot.action)] = slot;
+        }
+    }
+};
+
+// One Monte Carlo search tree.
+// With root parallelisation every thread owns one of these; with tree parallelisation all threads search the same one,
+// each with its own rollout policy and GameState copy, so only the nodes and the arena are shared.
+class MCTSTree {
+public:
+    explicit MCTSTree(const MCTSSettings& settings) : settings(settings) {}
+
+    // Sets up the root for a search from this position, keeping the matching subtree of the previous search if asked to
+    void reroot(const GameState& game, bool reuse_tree) {
+        Node* reused = reuse_tree ? find_position(game.hash) : nullptr;
+
+        // Move the reused subtree (or a fresh root) into the spare arena, then free the previous tree at once
+        Arena& spare = arenas[1 - current_arena];
+        spare.reset();
+        root = spare.create<Node>();
+        if (reused != nullptr) {
+            *root = *reused;
+            root->parent = nullptr;
+            root->next_sibling = nullptr;
+            copy_children(reused, root, spare);
+        }
+        arenas[current_arena].reset();
+        current_arena = 1 - current_arena;
+
+        last_reused_visits = root->visits;
+        reused_visits_total += root->visits;
+        played = nullptr;
+    }
+
+    static constexpr int clock_check_interval = 16; // iterations between two looks at the deadline
+
+    struct SearchStats {
+        int iterations = 0;
+        int iterations_saved = 0; // left in the budget when the search stopped early, estimated with a time limit
+    };
+
+    // Searches until either the iterations are done, the deadline has passed or, if stop_early, the move is decided.
+    // Safe to call from several threads at once, each with its own rollout policy; searchers is how many do,
+    // as the early stop has to account for the iterations left to all of them.
+    SearchStats search(const GameState& game, int iterations, PlayoutPolicy& playout_policy,
+                       std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max(),
+                       int searchers = 1, bool stop_early = true) {
+        auto start = std::chrono::steady_clock::now();
+        auto iterations_left = [&](int done) {
+            long long left = iterations - done;
+            if (deadline != std::chrono::steady_clock::time_point::max()) {
+                auto now = std::chrono::steady_clock::now();
+                double pace = done / std::max(std::chrono::duration<double>(now - start).count(), 1e-9); // iterations per second
+                left = std::min(left, static_cast<long long>(pace * std::chrono::duration<double>(deadline - now).count()));
+            }
+            return static_cast<int>(std::max(left, 0LL));
+        };
+
+        bool rave = settings.rave_equivalence > 0;
+        PlayedMoves played_moves; // only filled with RAVE
+        SearchStats stats;
+        int& i = stats.iterations;
+        while (i < iterations) {
+            if (i > 0 && i % clock_check_interval == 0 && std::chrono::steady_clock::now() >= deadline)
+                break;
+
             GameState game_copy = game;
-            this->game = &game_copy;
-            Node* node = tree_policy(root);
-            double reward = default_policy(node);
-            backup(node, reward);
+            Node* node = tree_policy(root, game_copy);
+            played_moves.clear();
+            Rewards rewards = default_policy(game_copy, playout_policy, rave ? &played_moves : nullptr);
+            backup(node, rewards);
+            if (rave)
+                backup_amaf(node, rewards, played_moves);
+            i++;
+
+            if (root->expanded() && root->move_count == 1) { // doesn't make sense to continue search if there's only one move
+                stats.iterations_saved = iterations_left(i);
+                break;
+            }
+            if (stop_early && settings.early_stop_interval > 0 && i % settings.early_stop_interval == 0) {
+                int left = iterations_left(i);
+                if (root_lead() > static_cast<long long>(left) * searchers) {
+                    stats.iterations_saved = left;
+                    break;
+                }
+            }
+        }
+        return stats;
+    }
+
+    void finish_search() { last_tree_bytes = arenas[current_arena].bytes_used(); }
+
+    // Remembers which child of the root was actually played, so the next reroot can find its subtree
+    void set_played(const Action& action) {
+        played = const_cast<Node*>(root->find_child(action));
+    }
+
+    // Throws if the statistics of the tree are inconsistent, e.g. after a data race between search threads.
+    // Only call this between searches.
+    void check_integrity() const {
+        std::vector<const Node*> queue{root};
+        for (std::size_t i = 0; i < queue.size(); i++) {
+            const Node* node = queue[i];
+            if (node->virtual_loss != 0)
+                throw std::runtime_error("MCTS node has virtual loss left after the search");
+            if (node->state == Node::EXPANDING)
+                throw std::runtime_error("MCTS node expansion was never finished");
+            for (const auto& reward : node->rewards) {
+                if (reward < 0 || reward > node->visits + 1e-9)
+                    throw std::runtime_error("MCTS node has more rewards than visits");
+            }
+            if (node->amaf_rewards < 0 || node->amaf_rewards > node->amaf_visits + 1e-9)
+                throw std::runtime_error("MCTS node has more AMAF rewards than AMAF visits");
 
-            if (root->children.size() == 1) { // doesn't make sense to continue search if there's only one move
-                return root->children[0]->action;
+            int child_visits = 0;
+            int linked_children = 0;
+            const Action* tried_end = node->moves + node->child_count;
+            for (const Node* child = node->children(); child != nullptr; child = child->next_sibling) {
+                if (child->parent != node)
+                    throw std::runtime_error("MCTS node has a wrong parent pointer");
+                if (std::find(node->moves, tried_end, child->action) == tried_end)
+                    throw std::runtime_error("MCTS node has a child for a move it hasn't tried");
+                child_visits += child->visits;
+                linked_children++;
+                queue.push_back(child);
             }
+            if (linked_children != node->child_count || node->child_count > node->move_count)
+                throw std::runtime_error("MCTS node has lost a child");
+            if (child_visits > node->visits)
+                throw std::runtime_error("MCTS node has fewer visits than its children");
+        }
+    }
+
+    const Node* get_root() const { return root; }
+    std::size_t tree_bytes() const { return last_tree_bytes; }
+    std::size_t peak_tree_bytes() const { return std::max(arenas[0].peak_bytes(), arenas[1].peak_bytes()); }
+    int reused_visits() const { return last_reused_visits; }
+    long long total_reused_visits() const { return reused_visits_total; }
+
+private:
+    const MCTSSettings& settings;
+    Node* root = nullptr;
+    Node* played = nullptr; // child of root chosen by the last move
+    Arena arenas[2]; // the tree lives in arenas[current_arena], the other one receives the subtree kept for the next move
+    std::mutex arena_mutex; // guards allocations from arenas[current_arena] during a search
+    int current_arena = 0;
+    std::size_t last_tree_bytes = 0;
+    int last_reused_visits = 0;
+    long long reused_visits_total = 0;
+
+    // Breadth-first search below the last played move for the node of the given position,
+    // which follows the moves the other players made since then. Returns nullptr if they left the tree.
+    Node* find_position(std::uint64_t hash) const {
+        if (played == nullptr)
+            return nullptr;
+
+        std::vector<Node*> queue{played};
+        for (std::size_t i = 0; i < queue.size(); i++) {
+            Node* node = queue[i];
+            if (node->hash == hash)
+                return node;
+            for (Node* child = node->children(); child != nullptr; child = child->next_sibling)
+                queue.push_back(child);
+        }
+        return nullptr;
+    }
+
+    // Copies the moves and the subtree below `from` into `arena`, as the children of `to`
+    static void copy_children(const Node* from, Node* to, Arena& arena) {
+        if (from->move_count > 0) {
+            Action* moves = arena.create_array<Action>(from->move_count);
+            std::copy(from->moves, from->moves + from->move_count, moves);
+            to->moves = moves;
+        }
+        if (from->priors != nullptr) {
+            float* priors = arena.create_array<float>(from->move_count);
+            std::copy(from->priors, from->priors + from->move_count, priors);
+            to->priors = priors;
+        }
+
+        to->first_child.store(nullptr, std::memory_order_relaxed);
+        Node* previous = nullptr;
+        for (const Node* child = from->children(); child != nullptr; child = child->next_sibling) {
+            Node* copy = arena.create<Node>();
+            *copy = *child;
+            copy->parent = to;
+            copy->next_sibling = nullptr;
+            if (previous == nullptr)
+                to->first_child.store(copy, std::memory_order_relaxed);
+            else
+                previous->next_sibling = copy;
+            previous = copy;
+            copy_children(child, copy, arena);
         }
-        return root->best_action(); //root->best_child(0)->action;
     }
 
-    Node* tree_policy(Node* node) {
-        while (!game->is_game_over()) {
-            if (!node->expanded) {
-                return expand(node);
-            } else {
-                node = node->best_child();
-                game->perform_action(node->action);
+    // Visits of the most visited child of the root minus those of the runner-up, which may be a move without a child yet
+    int root_lead() const {
+        if (!root->expanded() || root->move_count < 2)
+            return 0;
+        int best = 0, second = 0;
+        for (const Node* child = root->children(); child != nullptr; child = child->next_sibling) {
+            int child_visits = child->visits.load(std::memory_order_relaxed);
+            if (child_visits > best) {
+                second = best;
+                best = child_visits;
+            } else if (child_visits > second) {
+                second = child_visits;
             }
         }
+        return best - second;
+    }
+
+    // Descends to the first node whose move has no child yet and creates that child, which is where the rollout starts
+    Node* tree_policy(Node* node, GameState& game) {
+        node->virtual_loss.fetch_add(1, std::memory_order_relaxed);
+        while (!game.is_game_over()) {
+            if (!node->expanded() && !expand(node, game))
+                return node; // another thread is expanding it, roll out from here meanwhile
+
+            bool created = false;
+            Node* child = select_child(node, created);
+            if (child == nullptr)
+                return node; // the admitted children are still being linked in by other threads
+            child->virtual_loss.fetch_add(1, std::memory_order_relaxed);
+            game.perform_action<NullLog, false>(child->action);
+            child->hash.store(game.hash, std::memory_order_relaxed);
+            node = child;
+            if (created)
+                break;
+        }
         return node;
     }
 
-    Node* expand(Node* node) {
-        auto possible_moves = game->get_legal_actions();
+    // Lists the moves of the node without creating any children. Returns false if another thread got to expand it
+    bool expand(Node* node, GameState& game) {
+        Node::State unexpanded = Node::UNEXPANDED;
+        if (!node->state.compare_exchange_strong(unexpanded, Node::EXPANDING, std::memory_order_acquire))
+            return false;
+
+        MoveList moves;
+        game.get_legal_actions(moves);
+        remove_duplicates(moves);
+
+        bool puct = settings.puct_weight > 0;
+        Priors priors;
+        if (puct || settings.admitted_children(1, moves.size()) < int(moves.size()))
+            sort_by_prior(moves, priors, game);
 
-        // Expand the node with all new children
-        for (const auto& move : possible_moves) {
-            bool move_exists = false;
+        Action* node_moves;
+        float* node_priors = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(arena_mutex);
+            node_moves = arenas[current_arena].create_array<Action>(moves.size());
+            if (puct)
+                node_priors = arenas[current_arena].create_array<float>(moves.size());
+        }
+        std::copy(moves.begin(), moves.end(), node_moves);
+        if (puct)
+            std::copy(priors.begin(), priors.end(), node_priors);
+        node->moves = node_moves;
+        node->priors = node_priors;
+        node->move_count = moves.size();
+        node->player = static_cast<std::int8_t>(game.get_current_player_idx());
+
+        node->state.store(Node::EXPANDED, std::memory_order_release);
+        return true;
+    }
+
+    // A new child for the next untried move (setting created) or the best child, nullptr if there is none to choose yet
+    Node* select_child(Node* node, bool& created) {
+        if (settings.puct_weight <= 0 || node->priors == nullptr) {
+            if (Node* child = create_child(node)) {
+                created = true;
+                return child;
+            }
+            return node->best_child(settings);
+        }
 
-            for (const auto& child : node->children) { // TODO: fix this shit xD
-                if (child->action == move) {
-                    move_exists = true;
-                    continue;
+        double best_value;
+        Node* best = node->best_child(settings, &best_value);
+        int next_move = node->child_count.load(std::memory_order_relaxed);
+        if (next_move < node->move_count) {
+            double untried_value = node->value() +
+                settings.puct_weight * node->priors[next_move] * std::sqrt(node->visits.load(std::memory_order_relaxed));
+            if (best == nullptr || untried_value > best_value) {
+                if (Node* child = create_child(node)) {
+                    created = true;
+                    return child;
                 }
             }
+        }
+        return best;
+    }
+
+    // Creates the child of the next move without one, if progressive widening admits it by now, otherwise returns nullptr.
+    // Every move gets one child even when several threads race for it: each claims its index in child_count first.
+    Node* create_child(Node* node) {
+        int admitted = settings.admitted_children(node->visits.load(std::memory_order_relaxed), node->move_count);
+        int idx = node->child_count.load(std::memory_order_relaxed);
+        do {
+            if (idx >= admitted)
+                return nullptr;
+        } while (!node->child_count.compare_exchange_weak(idx, idx + 1, std::memory_order_relaxed));
 
-            if (!move_exists) {
-                auto new_node = std::make_unique<Node>(move, node);
-                node->children.push_back(std::move(new_node));
+        Node* child;
+        {
+            std::lock_guard<std::mutex> lock(arena_mutex);
+            child = arenas[current_arena].create<Node>(node->moves[idx], node);
+        }
+        if (node->priors != nullptr)
+            child->prior = node->priors[idx];
+        child->next_sibling = node->first_child.load(std::memory_order_relaxed);
+        while (!node->first_child.compare_exchange_weak(child->next_sibling, child, std::memory_order_release,
+                                                        std::memory_order_relaxed)) {}
+        return child;
+    }
+
+    // Removes duplicate moves, keeping the first occurrence.
+    // The moves seen so far are kept in an open addressing table on action_hash, so this is linear in the number of moves.
+    static void remove_duplicates(MoveList& moves) {
+        constexpr std::size_t max_table_size = 1024;
+        static_assert(max_table_size >= 2 * MAX_LEGAL_ACTIONS, "the table must stay at most half full");
+        std::size_t table_size = 16;
+        while (table_size < 2 * moves.size())
+            table_size *= 2;
+        std::uint16_t slots[max_table_size]; // 1 + index into the unique moves, 0 for an empty slot
+        std::fill_n(slots, table_size, 0);
+
+        std::size_t unique_count = 0;
+        for (std::size_t i = 0; i < moves.size(); i++) {
+            std::size_t slot = action_hash(moves[i]) & (table_size - 1);
+            while (slots[slot] != 0 && !(moves[slots[slot] - 1] == moves[i]))
+                slot = (slot + 1) & (table_size - 1);
+            if (slots[slot] == 0) {
+                moves[unique_count++] = moves[i];
+                slots[slot] = static_cast<std::uint16_t>(unique_count);
             }
         }
+        moves.resize(unique_count);
+    }
 
-        node->expanded = true;
+    // Sorts the moves and their priors best prior first, the order their children are created in
+    void sort_by_prior(MoveList& moves, Priors& priors, GameState& game) {
+        settings.prior_provider->priors(game, moves, priors);
+        FixedVector<std::pair<double, int>, MAX_LEGAL_ACTIONS> order; // (-prior, index), so ties keep the generation order
+        for (std::size_t i = 0; i < moves.size(); i++)
+            order.push_back({-priors[i], int(i)});
+        std::sort(order.begin(), order.end());
 
-        return node->best_child();
+        MoveList sorted_moves;
+        Priors sorted_priors;
+        for (const auto& entry : order) {
+            sorted_moves.push_back(moves[entry.second]);
+            sorted_priors.push_back(priors[entry.second]);
+        }
+        moves = sorted_moves;
+        priors = sorted_priors;
     }
 
-    double default_policy(Node* node) {
-        // Random rollout
-        Player random_player(*game, new RandomStrategy());
+    // Plays the game out, or until the rollout is truncated, recording the moves in played_moves unless it is nullptr
+    Rewards default_policy(GameState& game, PlayoutPolicy& playout_policy, PlayedMoves* played_moves) {
+        int start_round = game.round;
+        try {
+            for (int plies = 0; !game.is_game_over(); plies++) {
+                if (settings.truncates(plies, game.round - start_round))
+                    return evaluated_rewards(game);
 
-        while(true) {
-            try {
-                random_player.make_move();
-            } catch (const std::runtime_error& e) {
-                std::cout << e.what() << std::endl;
-                throw e;
+                Action action = playout_policy.choose_action(game);
+                if (played_moves != nullptr)
+                    played_moves->insert(game.get_current_player_idx(), action);
+                game.perform_action<NullLog, false>(action);
             }
+        } catch (const std::runtime_error& e) {
+            std::cout << e.what() << std::endl;
+            throw e;
+        }
+
+        Rewards rewards;
+        for (int i = 0; i < game.player_count; i++) {
+            if (settings.placement_rewards)
+                rewards.push_back(1.0 - double(game.player_placements[i]) / (game.player_count - 1));
+            else
+                rewards.push_back(game.winner == i ? 1.0 : 0.0);
+        }
+        return rewards;
+    }
 
-            if (game->is_game_over()) {
-                return game->winner == player_idx ? 1.0 : 0.0;
-                // TODO: can try giving rewards between 0 and 1 depending on how close we got to winning
+    // Rewards of a position the rollout stopped at before the end of the game, see MCTSSettings::rollout_rounds
+    Rewards evaluated_rewards(const GameState& game) const {
+        Scores scores;
+        settings.rollout_evaluator->evaluate(game, scores);
+
+        Rewards rewards;
+        if (settings.placement_rewards) {
+            for (int i = 0; i < game.player_count; i++) {
+                int placement = 0;
+                for (int j = 0; j < game.player_count; j++)
+                    placement += scores[j] > scores[i] || (scores[j] == scores[i] && j < i);
+                rewards.push_back(1.0 - double(placement) / (game.player_count - 1));
             }
+            return rewards;
+        }
+
+        double max_score = *std::max_element(scores.begin(), scores.end());
+        double total = 0;
+        for (int i = 0; i < game.player_count; i++) {
+            rewards.push_back(std::exp((scores[i] - max_score) / settings.evaluation_temperature));
+            total += rewards[i];
         }
+        for (auto& reward : rewards)
+            reward /= total;
+        return rewards;
     }
 
-    void backup(Node* node, double reward) {
+    void backup(Node* node, const Rewards& rewards) {
         while (node != nullptr) {
-            node->visits += 1;
-            node->wins += reward;
+            node->visits.fetch_add(1, std::memory_order_relaxed);
+            for (std::size_t i = 0; i < rewards.size(); i++)
+                add(node->rewards[i], rewards[i]);
+            node->virtual_loss.fetch_sub(1, std::memory_order_relaxed);
             node = node->parent;
         }
     }
+
+    // RAVE: walks up from the leaf, adding the moves of the path to those of the rollout,
+    // and credits every child whose move was made by its parent's player anywhere below the parent
+    void backup_amaf(Node* leaf, const Rewards& rewards, PlayedMoves& played_moves) {
+        for (Node* child = leaf; child->parent != nullptr; child = child->parent) {
+            Node* node = child->parent;
+            played_moves.insert(node->player, child->action);
+            double reward = rewards[node->player];
+            for (Node* sibling = node->children(); sibling != nullptr; sibling = sibling->next_sibling) {
+                if (played_moves.contains(node->player, sibling->action)) {
+                    sibling->amaf_visits.fetch_add(1, std::memory_order_relaxed);
+                    add(sibling->amaf_rewards, reward);
+                }
+            }
+        }
+    }
+
+    static void add(std::atomic<double>& sum, double value) {
+        double expected = sum.load(std::memory_order_relaxed);
+        while (!sum.compare_exchange_weak(expected, expected + value, std::memory_order_relaxed)) {}
+    }
+};
+
+enum class MCTSParallelism : std::uint8_t {
+    ROOT = 0, // one tree per thread, root statistics merged before choosing a move
+    TREE = 1, // all threads search a single shared tree
+};
+
+// Monte Carlo Tree Search
+// With threads > 1 and ROOT parallelism every thread grows its own tree from the same position
+// (with its own RNG stream), and the visits and rewards of the root children are summed before picking a move.
+// Trees are merged in thread order and every thread runs a fixed number of iterations,
+// so for a given seed and thread count the chosen moves don't depend on scheduling.
+// With TREE parallelism the threads share one tree and spread out over it through virtual loss;
+// that makes better use of the memory, but the result depends on how the threads interleave.
+class MCTSStrategy : public Strategy {
+public:
+    // iterations are per thread
+    // reuse_tree keeps the subtree of the position reached since the last move instead of starting every search from scratch
+    MCTSStrategy(int iterations = 1000, bool reuse_tree = true, int threads = 1,
+                 std::uint64_t seed = std::random_device{}(), MCTSParallelism parallelism = MCTSParallelism::ROOT)
+        : iterations(iterations), reuse_tree(reuse_tree), seed(seed) {
+        threads = std::max(threads, 1);
+        int tree_count = parallelism == MCTSParallelism::TREE ? 1 : threads;
+        for (int i = 0; i < tree_count; i++)
+            trees.push_back(std::make_unique<MCTSTree>(settings));
+        playout_policies.resize(threads);
+        thread_stats.resize(threads);
+        set_playout_policy([](Rng rng) { return std::make_unique<RandomPlayout>(rng); });
+    }
+
+    // Searches every move for the given wall-clock time instead of a fixed number of iterations.
+    // The deadline is checked every MCTSTree::clock_check_interval iterations, and at least one iteration always runs.
+    // Moves then depend on the machine's speed, so they are no longer reproducible from the seed.
+    MCTSStrategy(std::chrono::milliseconds time_limit, bool reuse_tree = true, int threads = 1,
+                 std::uint64_t seed = std::random_device{}(), MCTSParallelism parallelism = MCTSParallelism::ROOT)
+        : MCTSStrategy(std::numeric_limits<int>::max(), reuse_tree, threads, seed, parallelism) {
+        this->time_limit = time_limit;
+    }
+
+    void make_move(GameState& game) override {
+        auto deadline = time_limit.count() > 0 ? std::chrono::steady_clock::now() + time_limit
+                                               : std::chrono::steady_clock::time_point::max();
+        for (auto& tree : trees)
+            tree->reroot(game, reuse_tree);
+
+        auto run = [&](int thread_idx) {
+            MCTSTree& tree = *trees[thread_idx % trees.size()];
+            int searchers = thread_count() / trees.size();
+            // a lead within one of several trees doesn't decide the move, which merged_best_action() picks from all of them
+            bool stop_early = trees.size() == 1;
+            thread_stats[thread_idx] = tree.search(game, iterations, *playout_policies[thread_idx], deadline,
+                                                   searchers, stop_early);
+        };
+
+        std::vector<std::thread> workers;
+        for (int i = 1; i < thread_count(); i++)
+            workers.emplace_back(run, i);
+        run(0);
+        for (auto& worker : workers)
+            worker.join();
+
+        for (auto& tree : trees)
+            tree->finish_search();
+
+        Action action = merged_best_action();
+        for (auto& tree : trees)
+            tree->set_played(action);
+        game.perform_action(action);
+    }
+
+    int thread_count() const { return playout_policies.size(); }
+
+    using PlayoutPolicyFactory = std::function<std::unique_ptr<PlayoutPolicy>(Rng rng)>;
+
+    // One rollout policy per thread, each made with the thread's RNG stream. RandomPlayout by default
+    void set_playout_policy(const PlayoutPolicyFactory& make_policy) {
+        for (int i = 0; i < thread_count(); i++)
+            playout_policies[i] = make_policy(Rng(seed, i));
+    }
+
+    MCTSSettings settings; // can be changed between moves
+
+    // Iterations of the last move's search, summed over all threads
+    int iterations_reached() const {
+        int total = 0;
+        for (const auto& stats : thread_stats)
+            total += stats.iterations;
+        return total;
+    }
+
+    // Iterations of the last move's budget left unused because the move was decided early, summed over all threads
+    int iterations_saved() const {
+        int total = 0;
+        for (const auto& stats : thread_stats)
+            total += stats.iterations_saved;
+        return total;
+    }
+
+    void check_integrity() const {
+        for (const auto& tree : trees)
+            tree->check_integrity();
+    }
+
+    // Summed over all trees
+    std::size_t tree_bytes() const { return sum(&MCTSTree::tree_bytes); } // size of the last move's search trees
+    std::size_t peak_tree_bytes() const { return sum(&MCTSTree::peak_tree_bytes); } // largest search trees so far
+    int reused_visits() const { return sum(&MCTSTree::reused_visits); } // visits carried over into the last move's search
+    long long total_reused_visits() const { return sum(&MCTSTree::total_reused_visits); }
+
+private:
+    int iterations;
+    std::chrono::milliseconds time_limit{0}; // 0 runs all iterations
+    bool reuse_tree;
+    std::uint64_t seed;
+    std::vector<std::unique_ptr<MCTSTree>> trees; // thread i searches trees[i % trees.size()], thread 0 is the calling thread
+    std::vector<std::unique_ptr<PlayoutPolicy>> playout_policies; // one per thread
+    std::vector<MCTSTree::SearchStats> thread_stats; // of each thread in the last search
+
+    // Returns the move with most visits summed over all trees, ties broken by the summed rewards of the player to move
+    // and then by the order of the moves.
+    // All trees expand the same root position into the same moves, but each creates its own children of them,
+    // so children are matched by action.
+    Action merged_best_action() const {
+        const Node* first = trees[0]->get_root();
+        Action best_action;
+        int best_visits = -1;
+        double best_reward = 0;
+        for (int i = 0; i < first->move_count; i++) {
+            const Action& action = first->moves[i];
+            int visits = 0;
+            double reward = 0;
+            for (const auto& tree : trees) {
+                if (const Node* child = tree->get_root()->find_child(action)) {
+                    visits += child->visits;
+                    reward += child->rewards[first->player];
+                }
+            }
+            if (visits > best_visits || (visits == best_visits && reward > best_reward)) {
+                best_action = action;
+                best_visits = visits;
+                best_reward = reward;
+            }
+        }
+        return best_action;
+    }
+
+    template <typename T>
+    T sum(T (MCTSTree::*stat)() const) const {
+        T total = 0;
+        for (const auto& tree : trees)
+            total += ((*tree).*stat)();
+        return total;
+    }
 };
 
-#endif // MONTE_CARLO_STRATEGY_H
\ No newline at end of file
+#endif // MONTE_CARLO_STRATEGY_H
@@ -0,0 +1,67 @@
+#ifndef PLAYOUT_POLICY_H
+#define PLAYOUT_POLICY_H
+
+#include "basic_heuristic.h"
+#include "game.h"
+#include "random_strategy.h"
+#include "rng.h"
+
+#include <limits>
+#include <stdexcept>
+
+// Chooses the moves of MCTS rollouts. Every search thread owns one, so implementations need no locking.
+class PlayoutPolicy {
+public:
+    virtual ~PlayoutPolicy() = default;
+
+    // Leaves the game as it was, see BasicHeuristic::evaluate_move()
+    virtual Action choose_action(GameState& game) = 0;
+};
+
+// Uniformly random moves, see RandomStrategy::choose_action()
+class RandomPlayout : public PlayoutPolicy {
+    RandomStrategy random;
+public:
+    explicit RandomPlayout(Rng rng) : random(rng) {}
+
+    Action choose_action(GameState& game) override { return random.choose_action(game); }
+};
+
+// Random move with probability epsilon, otherwise the one raising the mover's BasicHeuristic score most
+class EpsilonGreedyPlayout : public PlayoutPolicy {
+    RandomStrategy random;
+    Rng rng;
+    std::uint32_t random_threshold; // rng() below this plays a random move
+    BasicHeuristic heuristic;
+    MoveList moves; // reused, so a greedy move doesn't build a 5 KB list on the stack
+public:
+    explicit EpsilonGreedyPlayout(Rng rng, double epsilon = 0.3)
+        : random(rng.split()), rng(rng), random_threshold(static_cast<std::uint32_t>(epsilon * Rng::max())) {}
+
+    Action choose_action(GameState& game) override {
+        if (rng() < random_threshold)
+            return random.choose_action(game);
+
+        moves.clear();
+        game.get_legal_actions(moves);
+        if (moves.empty())
+            throw std::runtime_error("No legal actions");
+
+        Action best_action;
+        int best_score = std::numeric_limits<int>::min();
+        std::uint32_t ties = 0;
+        for (const auto& move : moves) {
+            int score = heuristic.evaluate_move(game, move);
+            if (score > best_score) {
+                best_score = score;
+                best_action = move;
+                ties = 1;
+            } else if (score == best_score && rng() % ++ties == 0) {
+                best_action = move;
+            }
+        }
+        return best_action;
+    }
+};
+
+#endif // PLAYOUT_POLICY_H
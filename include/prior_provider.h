@@ -0,0 +1,47 @@
+#ifndef PRIOR_PROVIDER_H
+#define PRIOR_PROVIDER_H
+
+#include "basic_heuristic.h"
+#include "fixed_vector.h"
+#include "game.h"
+
+#include <algorithm>
+#include <cmath>
+
+using Priors = FixedVector<double, MAX_LEGAL_ACTIONS>;
+
+// Move priors for PUCT and progressive widening, shared by all search threads
+class PriorProvider {
+public:
+    virtual ~PriorProvider() = default;
+
+    // Fills priors[i] for moves[i], summing to 1. Leaves the game as it was, see BasicHeuristic::evaluate_move()
+    virtual void priors(GameState& game, const MoveList& moves, Priors& priors) const = 0;
+};
+
+// Softmax over the BasicHeuristic score the mover has after each move, at the given temperature in score points
+class HeuristicPriors : public PriorProvider {
+    double temperature;
+public:
+    explicit HeuristicPriors(double temperature = 1.0) : temperature(temperature) {}
+
+    void priors(GameState& game, const MoveList& moves, Priors& priors) const override {
+        BasicHeuristic heuristic; // evaluate_move() isn't const, so every call gets its own
+        priors.clear();
+        for (const auto& move : moves)
+            priors.push_back(heuristic.evaluate_move(game, move));
+        if (priors.empty())
+            return;
+
+        double max_score = *std::max_element(priors.begin(), priors.end());
+        double total = 0;
+        for (auto& prior : priors) {
+            prior = std::exp((prior - max_score) / temperature);
+            total += prior;
+        }
+        for (auto& prior : priors)
+            prior /= total;
+    }
+};
+
+#endif // PRIOR_PROVIDER_H
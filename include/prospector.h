@@ -3,15 +3,25 @@
 
 #include "action.h"
 
-class ProspectorAction : public ActionBase {
-    static const PlayerRole role = PlayerRole::PROSPECTOR;
+class ProspectorAction : public ActionGenerator<ProspectorAction> {
+    PlayerRole role; // PROSPECTOR or PROSPECTOR_2, both behave the same
 public:
-    void perform(GameState& game, const Action& action) const override;
-    std::vector<Action> get_legal_actions(const GameState& game, bool bonus = false) const override;
+    explicit ProspectorAction(PlayerRole role = PlayerRole::PROSPECTOR) : role(role) {}
+
+    template <typename Log>
+    void perform(GameState& game, const Action& action) const;
+
+private:
+    friend class ActionGenerator<ProspectorAction>;
+    template <typename Sink>
+    void generate_actions(const GameState& game, bool bonus, Sink& sink) const;
 };
 
+extern template class ActionGenerator<ProspectorAction>;
+
 class Prospector2Action : public ProspectorAction {
-    static const PlayerRole role = PlayerRole::PROSPECTOR_2;
+public:
+    Prospector2Action() : ProspectorAction(PlayerRole::PROSPECTOR_2) {}
 };
 
 #endif // Prospector_H
\ No newline at end of file
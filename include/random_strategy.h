@@ -2,39 +2,53 @@
 #define RANDOM_STRATEGY_H
 
 #include "game.h"
+#include "rng.h"
 #include "strategy.h"
 
 #include <random>
 
 class RandomStrategy : public Strategy {
-    std::mt19937 rng;
+    Rng rng;
 public:
     RandomStrategy(int seed = std::random_device()()) : rng(seed) {}
+    explicit RandomStrategy(Rng rng) : rng(rng) {}
     ~RandomStrategy() override = default;
 
     void make_move(GameState& game) override {
-        std::vector<Action> actions = game.get_legal_actions();
-        
-        // It is good to avoid overrepresenting Roles that have a higher number of legal Actions (Mayor, Settler, Builder)
-        // So we first pick a random Role, then independantly choose an Action belonging to that Role
-
-        std::set<PlayerRole> roles;
-        for (const auto& action : actions) {
-            roles.insert(action.type);
-        }
-        std::vector<PlayerRole> role_vector(roles.begin(), roles.end());
-        int role_idx = rng() % role_vector.size();
-        PlayerRole role = role_vector[role_idx];
+        game.perform_action(choose_action(game));
+    }
 
-        actions.erase(std::remove_if(actions.begin(), actions.end(), [role](const Action& action) {
-            return action.type != role;
-        }), actions.end());
+    // Picks a Role uniformly among those with a legal Action, then one of that Role's Actions uniformly.
+    // This avoids overrepresenting Roles that have a higher number of legal Actions (Mayor, Settler, Builder).
+    // Only the chosen Action is generated, no move list is built.
+    Action choose_action(const GameState& game) {
+        if (game.current_role != PlayerRole::NONE) {
+            Action action = role_handler(game.current_role).random_legal_action(game, rng, false);
+            if (action.type == PlayerRole::NONE)
+                throw std::runtime_error("No legal actions");
+            return action;
+        }
 
-        if (actions.empty())
-            throw std::runtime_error("No legal actions");
+        FixedVector<PlayerRole, static_cast<int>(PlayerRole::NONE) + 1> roles;
+        for (const auto& role : game.role_state) {
+            if (!role.taken)
+                roles.push_back(role.role);
+        }
+        // draw Roles until one has legal Actions, dropping those that don't
+        while (!roles.empty()) {
+            auto role = roles.begin() + rng() % roles.size();
+            Action action = role_handler(*role).random_legal_action(game, rng, true);
+            if (action.type != PlayerRole::NONE)
+                return action;
+            roles.erase(role);
+        }
+        throw std::runtime_error("No legal actions");
+    }
 
-        int action_idx = rng() % actions.size();
-        game.perform_action(actions[action_idx]);
+    // Plays random moves until the game is over. No heap allocation or virtual calls.
+    void play_out(GameState& game) {
+        while (!game.is_game_over())
+            game.perform_action<NullLog, false>(choose_action(game));
     }
 };
 
@@ -0,0 +1,47 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+#include <limits>
+
+// PCG32 (XSH-RR variant, https://www.pcg-random.org) - 16 bytes of state instead of the 5 KB of std::mt19937,
+// so it can live inside GameState and be copied along with it for free.
+// Every generator belongs to one of 2^63 streams (selected by the odd increment), which lets us deterministically
+// split independent generators off a parent, e.g. one per parallel rollout worker.
+class Rng {
+    std::uint64_t state = 0;
+    std::uint64_t inc = 1;
+
+public:
+    using result_type = std::uint32_t;
+
+    explicit Rng(std::uint64_t seed = 0, std::uint64_t stream = 0) {
+        inc = (stream << 1u) | 1u;
+        (*this)();
+        state += seed;
+        (*this)();
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() {
+        std::uint64_t old_state = state;
+        state = old_state * 6364136223846793005ULL + inc;
+        auto xorshifted = static_cast<std::uint32_t>(((old_state >> 18u) ^ old_state) >> 27u);
+        auto rot = static_cast<std::uint32_t>(old_state >> 59u);
+        return (xorshifted >> rot) | (xorshifted << ((-rot) & 31u));
+    }
+
+    // Returns a new generator on a different stream, seeded from (and advancing) this one
+    Rng split() {
+        std::uint64_t seed = (std::uint64_t((*this)()) << 32) | (*this)();
+        std::uint64_t stream = (std::uint64_t((*this)()) << 32) | (*this)();
+        return Rng(seed, stream);
+    }
+
+    bool operator==(const Rng& other) const { return state == other.state && inc == other.inc; }
+    bool operator!=(const Rng& other) const { return !(*this == other); }
+};
+
+#endif // RNG_H
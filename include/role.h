@@ -1,9 +1,10 @@
 #ifndef ROLE_H
 #define ROLE_H
 
+#include <cstdint>
 #include <string>
 
-enum class PlayerRole {
+enum class PlayerRole : std::uint8_t {
     MAYOR = 0,
     CRAFTSMAN = 1,
     TRADER = 2,
@@ -1,7 +1,66 @@
+#ifndef ROLES_H
+#define ROLES_H
+
 #include "mayor.h"
 #include "settler.h"
 #include "craftsman.h"
 #include "builder.h"
 #include "captain.h"
 #include "trader.h"
-#include "prospector.h"
\ No newline at end of file
+#include "prospector.h"
+
+// Compile-time dispatch tables, indexed by PlayerRole, one per logging policy.
+// GameState looks up a Role's handlers with a single indirect call instead of walking an if-chain;
+// inside each handler the Role class is known statically, so its virtual methods are devirtualized.
+struct RoleHandler {
+    void (*perform)(GameState& game, const Action& action);
+    void (*get_legal_actions)(const GameState& game, MoveList& actions, bool bonus);
+    int (*count_legal_actions)(const GameState& game, bool bonus);
+    Action (*nth_legal_action)(const GameState& game, int k, bool bonus);
+    Action (*random_legal_action)(const GameState& game, Rng& rng, bool bonus);
+};
+
+template <typename RoleAction, typename Log>
+void perform_role(GameState& game, const Action& action) { RoleAction().template perform<Log>(game, action); }
+
+template <typename RoleAction>
+void role_legal_actions(const GameState& game, MoveList& actions, bool bonus) { RoleAction().get_legal_actions(game, actions, bonus); }
+
+template <typename RoleAction>
+int role_count_legal_actions(const GameState& game, bool bonus) { return RoleAction().count_legal_actions(game, bonus); }
+
+// Action is still incomplete here (game.h includes this header before defining it), so these return types have to be dependent
+template <typename RoleAction>
+auto role_nth_legal_action(const GameState& game, int k, bool bonus) -> decltype(RoleAction().nth_legal_action(game, k, bonus)) {
+    return RoleAction().nth_legal_action(game, k, bonus);
+}
+
+template <typename RoleAction>
+auto role_random_legal_action(const GameState& game, Rng& rng, bool bonus) -> decltype(RoleAction().random_legal_action(game, rng, bonus)) {
+    return RoleAction().random_legal_action(game, rng, bonus);
+}
+
+template <typename RoleAction, typename Log>
+constexpr RoleHandler make_role_handler() {
+    return {perform_role<RoleAction, Log>, role_legal_actions<RoleAction>, role_count_legal_actions<RoleAction>,
+            role_nth_legal_action<RoleAction>, role_random_legal_action<RoleAction>};
+}
+
+template <typename Log>
+inline constexpr RoleHandler RoleHandlers[] = {
+    make_role_handler<MayorAction, Log>(),
+    make_role_handler<CraftsmanAction, Log>(),
+    make_role_handler<TraderAction, Log>(),
+    make_role_handler<SettlerAction, Log>(),
+    make_role_handler<BuilderAction, Log>(),
+    make_role_handler<CaptainAction, Log>(),
+    make_role_handler<ProspectorAction, Log>(),
+    make_role_handler<Prospector2Action, Log>()
+};
+
+static_assert(sizeof(RoleHandlers<NullLog>) / sizeof(RoleHandler) == static_cast<int>(PlayerRole::NONE), "every Role needs a handler");
+
+template <typename Log = NullLog>
+const RoleHandler& role_handler(PlayerRole role) { return RoleHandlers<Log>[static_cast<int>(role)]; }
+
+#endif // ROLES_H
@@ -3,10 +3,17 @@
 
 #include "action.h"
 
-class SettlerAction : public ActionBase {
+class SettlerAction : public ActionGenerator<SettlerAction> {
 public:
-    void perform(GameState& game, const Action& action) const override;
-    std::vector<Action> get_legal_actions(const GameState& game, bool is_settler = false) const override;
+    template <typename Log>
+    void perform(GameState& game, const Action& action) const;
+
+private:
+    friend class ActionGenerator<SettlerAction>;
+    template <typename Sink>
+    void generate_actions(const GameState& game, bool is_settler, Sink& sink) const;
 };
 
+extern template class ActionGenerator<SettlerAction>;
+
 #endif // SETTLER_H
\ No newline at end of file
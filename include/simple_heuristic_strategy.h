@@ -17,9 +17,12 @@ public:
     ~SimpleHeuristicStrategy() override { delete evaluator; };
 
     void make_move(GameState& game) override {
-        std::vector<Action> actions = game.get_legal_actions();
+        MoveList actions;
+        game.get_legal_actions(actions);
         int player_idx = game.get_current_player_idx();
 
+        GameState state = game; // every candidate is tried in place on this copy and then undone
+
         // TODO: fix minor bug with Hacienda where secret rng information is revealed in the new GameState - need to reshuffle the deck every time
 
         // Find the action that maximizes the current player's score using the simple heuristic
@@ -27,11 +30,11 @@ public:
         double best_score = std::numeric_limits<int>::min();
 
         for (const auto& action : actions) {
-            GameState next_state = game;
-            next_state.perform_action(action);
+            UndoRecord undo = state.perform_action<NullLog>(action);
 
             // Original simple max score heuristic
-            double score = evaluator->evaluate(next_state, player_idx);
+            double score = evaluator->evaluate(state, player_idx);
+            state.undo_action(undo);
             if (score > best_score) {
                 best_score = score;
                 best_action = action;
@@ -1,16 +1,29 @@
 #ifndef STATE_EVALUATOR_H
 #define STATE_EVALUATOR_H
 
+#include "fixed_vector.h"
 #include "game.h"
 
+using Scores = FixedVector<double, 5>; // one per player
+
 class StateEvaluator {
 public:
     virtual ~StateEvaluator() = default;
     virtual std::vector<double> evaluate(const GameState &state) = 0;
 
+    // Same scores without a heap allocation, for search hot paths
+    virtual void evaluate(const GameState &state, Scores &scores) {
+        std::vector<double> score = evaluate(state);
+        scores.clear();
+        for (double value : score)
+            scores.push_back(value);
+    }
+
     double evaluate(const GameState &state, int player_idx) {
-        return evaluate(state)[player_idx];
+        Scores scores;
+        evaluate(state, scores);
+        return scores[player_idx];
     }
 };
 
-#endif // STATE_EVALUATOR_H
\ No newline at end of file
+#endif // STATE_EVALUATOR_H
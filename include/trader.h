@@ -3,10 +3,17 @@
 
 #include "action.h"
 
-class TraderAction : public ActionBase {
+class TraderAction : public ActionGenerator<TraderAction> {
 public:
-    void perform(GameState& game, const Action& action) const override;
-    std::vector<Action> get_legal_actions(const GameState& game, bool is_trader = false) const override;
+    template <typename Log>
+    void perform(GameState& game, const Action& action) const;
+
+private:
+    friend class ActionGenerator<TraderAction>;
+    template <typename Sink>
+    void generate_actions(const GameState& game, bool is_trader, Sink& sink) const;
 };
 
+extern template class ActionGenerator<TraderAction>;
+
 #endif // TRADER_H
\ No newline at end of file
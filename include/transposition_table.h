@@ -0,0 +1,77 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include "game.h"
+
+#include <cstdint>
+#include <vector>
+
+// Fixed-size hash table of already searched positions, keyed by GameState::hash.
+// One entry per slot; a slot is overwritten when its entry is from an older search (generation)
+// or was searched to at most the same depth as the new one.
+class TranspositionTable {
+public:
+    struct Entry {
+        std::uint64_t hash = 0;
+        double score[5]; // maxn score vector, one value per player
+        Action best_action; // PlayerRole::NONE for leaves. Not an index, as positions with equal hashes may differ in their rng
+        std::int8_t depth = -1; // -1 marks an empty slot
+        std::uint8_t generation = 0;
+    };
+
+    explicit TranspositionTable(std::size_t size) {
+        std::size_t slots = 1;
+        while (slots < size)
+            slots <<= 1;
+        if (size > 0)
+            table.resize(slots);
+        mask = slots - 1;
+    }
+
+    bool enabled() const { return !table.empty(); }
+
+    // Call once per move, so entries from previous searches are replaced first
+    void new_search() { generation++; }
+
+    // Returns the entry for this position if it was searched to at least the given depth
+    const Entry* probe(std::uint64_t hash, int depth) {
+        if (!enabled())
+            return nullptr;
+
+        probes++;
+        const Entry& entry = table[hash & mask];
+        if (entry.depth < depth || entry.hash != hash)
+            return nullptr;
+
+        hits++;
+        return &entry;
+    }
+
+    void store(std::uint64_t hash, int depth, const std::vector<double>& score, const Action& best_action) {
+        if (!enabled())
+            return;
+
+        Entry& entry = table[hash & mask];
+        if (entry.depth != -1 && entry.generation == generation && entry.depth > depth)
+            return; // keep the deeper result of the current search
+
+        entry.hash = hash;
+        entry.depth = depth;
+        entry.generation = generation;
+        entry.best_action = best_action;
+        for (std::size_t i = 0; i < score.size(); i++)
+            entry.score[i] = score[i];
+    }
+
+    std::uint64_t probe_count() const { return probes; }
+    std::uint64_t hit_count() const { return hits; }
+
+private:
+    std::vector<Entry> table;
+    std::size_t mask = 0;
+    std::uint8_t generation = 0;
+    std::uint64_t probes = 0;
+    std::uint64_t hits = 0;
+};
+
+#endif // TRANSPOSITION_TABLE_H
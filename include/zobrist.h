@@ -0,0 +1,18 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+
+// Zobrist-style keys for hashing a GameState.
+// Instead of tables of random numbers we derive the key of every (member, value) pair on the fly,
+// using the member's byte offset inside GameState as its identity and a SplitMix64 finalizer as the mixer.
+// Keys are combined by wrapping addition rather than XOR, so that equal elements of a container don't cancel out.
+inline std::uint64_t zobrist_key(std::uint64_t offset, int value) {
+    std::uint64_t z = (offset << 32) ^ static_cast<std::uint32_t>(value);
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+#endif // ZOBRIST_H
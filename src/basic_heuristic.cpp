@@ -4,19 +4,23 @@
 #include <vector>
 
 std::vector<double> BasicHeuristic::evaluate(const GameState &state) {
-    std::vector<double> score(state.player_count, 0.0);
+    Scores scores;
+    evaluate(state, scores);
+    return std::vector<double>(scores.begin(), scores.end());
+}
+
+void BasicHeuristic::evaluate(const GameState &state, Scores &scores) {
+    scores.clear();
 
     if (state.is_game_over()) {
         for (int i = 0; i < state.player_count; i++)
-            score[i] = (i == state.winner) ? 1000.0 : 0.0;
-        return score;
+            scores.push_back((i == state.winner) ? 1000.0 : 0.0);
+        return;
     }
 
     for (int i = 0; i < state.player_count; i++)
-        score[i] = evaluate(state.player_state[i]);
-    score[state.get_current_player_idx()] += 1.0;
-
-    return score;
+        scores.push_back(evaluate(state.player_state[i]));
+    scores[state.get_current_player_idx()] += 1.0;
 }
 
 double BasicHeuristic::building_value(BuildingType type) const {
@@ -73,3 +77,11 @@ int BasicHeuristic::evaluate(const PlayerState &state) {
 
     return score;
 }
+
+int BasicHeuristic::evaluate_move(GameState &game, const Action &action) {
+    int player_idx = game.get_current_player_idx();
+    UndoRecord undo = game.perform_action<NullLog>(action);
+    int score = evaluate(game.player_state[player_idx]);
+    game.undo_action(undo);
+    return score;
+}
@@ -1,8 +1,10 @@
 #include "builder.h"
 #include "game.h"
+#include "action_sink.h"
 
 #include <iostream>
 
+template <typename Log>
 void BuilderAction::perform(GameState& g, const Action& action) const {
     auto& player = g.player_state[g.current_player_idx];
 
@@ -20,24 +22,24 @@ void BuilderAction::perform(GameState& g, const Action& action) const {
         // TODO: method in game.h, also used in Settler.cpp for Hospice
         if (has_university) {
             if (g.colonist_supply > 0) {
-                g.colonist_supply -= 1;
+                g.add(g.colonist_supply, -1);
 
-                if (g.verbose)
-                    std::cout << "Player " << player.idx << " assigned a Colonist from the supply because of University" << std::endl;
+                if constexpr (Log::enabled)
+                    Log::out() << "Player " << player.idx << " assigned a Colonist from the supply because of University" << '\n';
             }
             else if (g.colonist_ship > 0) {
-                g.colonist_ship -= 1;
+                g.add(g.colonist_ship, -1);
 
-                if (g.verbose)
-                    std::cout << "Player " << player.idx << " assigned a Colonist from the ship because of University" << std::endl;
+                if constexpr (Log::enabled)
+                    Log::out() << "Player " << player.idx << " assigned a Colonist from the ship because of University" << '\n';
             }
             else 
                 has_university = false; // no extra Colonist
         }
 
-        player.buildings.push_back({action.building, has_university}); // only comes with a Colonist from University
-        player.doubloons -= action.building_cost;
-        player.free_town_space -= (action.building.cost() == 10) ? 2 : 1;
+        g.push_back(player.buildings, {action.building, has_university}); // only comes with a Colonist from University
+        g.add(player.doubloons, -action.building_cost);
+        g.add(player.free_town_space, (action.building.cost() == 10) ? -2 : -1);
 
         auto bit = std::find_if(g.building_supply.begin(), g.building_supply.end(), [&action](const BuildingSupply& building) {
             return building.building.type == action.building.type;
@@ -46,25 +48,24 @@ void BuilderAction::perform(GameState& g, const Action& action) const {
         if (bit == g.building_supply.end() || bit->count <= 0)
             throw std::runtime_error("Chosen building not found in building supply");
 
-        bit->count--; // one less instance of this building available
+        g.add(bit->count, -1); // one less instance of this building available
 
         if (action.building.type == BuildingType::WHARF)
-            g.ships.push_back({Ship::WHARF_CAPACITY, Good::NONE, 0, player.idx}); // new private ship with effectively infinite capacity
+            g.push_back(g.ships, {Ship::WHARF_CAPACITY, Good::NONE, 0, player.idx}); // new private ship with effectively infinite capacity
 
-        if (g.verbose)
-            std::cout << "Player " << player.idx << " built a " << action.building.name()
-                << " for " << action.building_cost << " doubloons" << std::endl;
+        if constexpr (Log::enabled)
+            Log::out() << "Player " << player.idx << " built a " << action.building.name()
+                << " for " << int(action.building_cost) << " doubloons" << '\n';
 
         if (player.free_town_space == 0)
-            g.trigger_game_end("A Town has been built to completion");
+            g.trigger_game_end<Log>("A Town has been built to completion");
     }
 
-    g.next_player();
+    g.next_player<Log>();
 }
 
-std::vector<Action> BuilderAction::get_legal_actions(const GameState& g, bool is_builder) const {
-    std::vector<Action> actions;
-
+template <typename Sink>
+void BuilderAction::generate_actions(const GameState& g, bool is_builder, Sink& sink) const {
     const auto& player = g.player_state[g.current_player_idx];
 
     int builder_role_doubloons = 0;
@@ -95,11 +96,13 @@ std::vector<Action> BuilderAction::get_legal_actions(const GameState& g, bool is
         // allow building if enough doubloons
         int building_cost = std::max(0, building.building.cost() - std::min(building.building.max_discount(), quarries) - is_builder);
         if (building_cost <= doubloons) {
-            actions.emplace_back(building.building, building_cost);
+            sink(Action(building.building, building_cost));
         }
     }
 
-    actions.emplace_back(Building(BuildingType::NONE), 0);
+    sink(Action(Building(BuildingType::NONE), 0));
+}
 
-    return actions;
-}
\ No newline at end of file
+template void BuilderAction::perform<NullLog>(GameState& g, const Action& action) const;
+template void BuilderAction::perform<ConsoleLog>(GameState& g, const Action& action) const;
+template class ActionGenerator<BuilderAction>;
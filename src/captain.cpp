@@ -1,27 +1,31 @@
 #include "captain.h"
 #include "game.h"
+#include "action_sink.h"
 
 #include <iostream>
 
+template <typename Log>
 void CaptainAction::perform(GameState& g, const Action& action) const {
     auto& player = g.player_state[g.current_player_idx];
 
-    if (g.verbose && g.current_player_idx == g.current_round_player_idx && action.sell_price > 0) {
-        for (int i = 0; i < g.player_count; i++) {
-            int pidx = (g.current_player_idx + i) % g.player_count;
-            std::cout << "Player " << pidx << " has: ";
-            for (int j = 0; j < 5; j++) {
-                if (g.player_state[pidx].goods[j] > 0)
-                    std::cout << g.player_state[pidx].goods[j] << " " << GoodNames[j] << ", ";
+    if constexpr (Log::enabled) {
+        if (g.current_player_idx == g.current_round_player_idx && action.sell_price > 0) {
+            for (int i = 0; i < g.player_count; i++) {
+                int pidx = (g.current_player_idx + i) % g.player_count;
+                Log::out() << "Player " << pidx << " has: ";
+                for (int j = 0; j < 5; j++) {
+                    if (g.player_state[pidx].goods[j] > 0)
+                        Log::out() << g.player_state[pidx].goods[j] << " " << GoodNames[j] << ", ";
+                }
+                Log::out() << '\n';
             }
-            std::cout << std::endl;
-        }
 
-        std::cout << "Ships contain: ";
-        for (const auto& ship : g.ships) {
-            std::cout << ship.good_count << "/" << ship.capacity << " " << good_name(ship.good) << ", ";
+            Log::out() << "Ships contain: ";
+            for (const auto& ship : g.ships) {
+                Log::out() << ship.good_count << "/" << ship.capacity << " " << good_name(ship.good) << ", ";
+            }
+            Log::out() << '\n';
         }
-        std::cout << std::endl;
     }
 
     if (action.good != Good::NONE) {
@@ -31,9 +35,9 @@ void CaptainAction::perform(GameState& g, const Action& action) const {
             return ship.capacity == action.ship_capacity;
         });
         
-        ship.good = action.good;
+        g.set(ship.good, action.good);
         int gidx = static_cast<int>(action.good);
-        int good_count = std::min(ship.capacity - ship.good_count, player.goods[gidx]);
+        int good_count = std::min<int>(ship.capacity - ship.good_count, player.goods[gidx]);
         
         if (good_count == 0)
             throw std::runtime_error("No goods to load onto ship");
@@ -47,56 +51,58 @@ void CaptainAction::perform(GameState& g, const Action& action) const {
                 has_harbor = true;
         }
         
-        ship.good_count += good_count;
-        player.goods[gidx] -= good_count;
+        g.add(ship.good_count, good_count);
+        g.add(player.goods[gidx], -good_count);
         int vps = good_count + action.sell_price + has_harbor; // 1 VP per good + 1 VP for Captain bonus + 1 VP for Harbor bonus
-        player.victory_points += vps; 
-        g.victory_points_supply -= vps;
+        g.add(player.victory_points, vps);
+        g.add(g.victory_points_supply, -vps);
 
         if (g.victory_points_supply <= 0)
-            g.trigger_game_end("Not enough Victory Points available");
+            g.trigger_game_end<Log>("Not enough Victory Points available");
 
-        if (g.verbose) {
-            std::cout << "Player " << g.current_player_idx << " loaded " << good_count << " " 
-                << good_name(action.good) << " onto Ship of size " << ship.capacity << std::endl;
+        if constexpr (Log::enabled) {
+            Log::out() << "Player " << g.current_player_idx << " loaded " << good_count << " " 
+                << good_name(action.good) << " onto Ship of size " << ship.capacity << '\n';
 
-            std::cout << "Player " << g.current_player_idx << " got " << vps << " Victory Points" << std::endl;
+            Log::out() << "Player " << g.current_player_idx << " got " << vps << " Victory Points" << '\n';
 
-            std::cout << "Ships now contain: ";
+            Log::out() << "Ships now contain: ";
             for (const auto& ship : g.ships) {
-                std::cout << ship.good_count << "/" << ship.capacity << " " << good_name(ship.good) << ", ";
+                Log::out() << ship.good_count << "/" << ship.capacity << " " << good_name(ship.good) << ", ";
             }
-            std::cout << std::endl;
+            Log::out() << '\n';
         }
 
-        g.cant_ship_counter = 0;
+        g.set(g.cant_ship_counter, 0);
     } else {
         // Can't ship anything else, time to store Goods in Warehouses
 
-        if (g.verbose)
-            std::cout << "Player " << g.current_player_idx << " can't ship any more goods" << std::endl;
+        if constexpr (Log::enabled)
+            Log::out() << "Player " << g.current_player_idx << " can't ship any more goods" << '\n';
 
         auto& kept_goods = action.mayor_allocation.distribution;
         for (int i = 0; i < 5; i++) {
-            if (g.verbose && kept_goods.w[i] != player.goods[i])
-                std::cout << "Player " << g.current_player_idx << " threw away " << player.goods[i] - kept_goods.w[i] << " " << GoodNames[i] << std::endl;
+            if constexpr (Log::enabled) {
+                if (kept_goods.w[i] != player.goods[i])
+                    Log::out() << "Player " << g.current_player_idx << " threw away " << player.goods[i] - kept_goods.w[i] << " " << GoodNames[i] << '\n';
+            }
 
-            g.good_supply[i] += player.goods[i] - kept_goods.w[i];
-            player.goods[i] = kept_goods.w[i];
+            g.add(g.good_supply[i], player.goods[i] - kept_goods.w[i]);
+            g.set(player.goods[i], kept_goods.w[i]);
         }
 
-        g.cant_ship_counter++;
+        g.add(g.cant_ship_counter, 1);
     }
 
-    g.next_player();
+    g.next_player<Log>();
 }
 
-std::vector<Action> CaptainAction::get_legal_actions(const GameState& g, bool is_captain) const {
-    std::vector<Action> actions;
-
+template <typename Sink>
+void CaptainAction::generate_actions(const GameState& g, bool is_captain, Sink& sink) const {
     const auto& player = g.player_state[g.current_player_idx];
 
     bool has_wharf = player.has(BuildingType::WHARF);
+    bool can_ship = false;
 
     for (const auto& ship : g.ships) {
         if (ship.is_wharf() && !(has_wharf && ship.owner == player.idx))
@@ -117,14 +123,15 @@ std::vector<Action> CaptainAction::get_legal_actions(const GameState& g, bool is
             }
 
             if (player.goods[i] > 0 && ship.capacity - ship.good_count > 0 && (ship.good_count == 0 || ship.good == good)) {
-                actions.emplace_back(ship.capacity, good, is_captain);
+                sink(Action(ship.capacity, good, is_captain));
+                can_ship = true;
             }
 
             next_good:;
         }
     }
 
-    if (actions.empty()) { // throw away remaining goods, save some in warehouses
+    if (!can_ship) { // throw away remaining goods, save some in warehouses
         int can_store_types = 0;
         for (const auto& building : player.buildings) {
             if (building.colonists == 0)
@@ -147,15 +154,15 @@ std::vector<Action> CaptainAction::get_legal_actions(const GameState& g, bool is
 
         if (good_type_cnt <= can_store_types || (good_type_cnt == 1 + can_store_types && alone_good_cnt > 0)) {
             // can store everything
-            actions.emplace_back(ProductionDistribution{player.goods[0], player.goods[1], player.goods[2], player.goods[3], player.goods[4], 0}, is_captain);
+            sink(Action(ProductionDistribution{player.goods[0], player.goods[1], player.goods[2], player.goods[3], player.goods[4], 0}, is_captain));
         } else {
             // greedily store the most abundant goods - tiebreaker higher value
             int stored_goods[5] = {0, 0, 0, 0, 0};
-            std::vector<std::pair<int, int>> goods; // (good_count, good_index)
+            std::pair<int, int> goods[5]; // (good_count, good_index)
             for (int i = 0; i < 5; i++) {
-                goods.emplace_back(player.goods[i], i);
+                goods[i] = {player.goods[i], i};
             }
-            std::sort(goods.begin(), goods.end(), std::greater<std::pair<int, int>>());
+            std::sort(goods, goods + 5, std::greater<std::pair<int, int>>());
 
             for (int i = 0; i < can_store_types; i++) {
                 stored_goods[goods[i].second] = player.goods[goods[i].second];
@@ -169,9 +176,11 @@ std::vector<Action> CaptainAction::get_legal_actions(const GameState& g, bool is
                 }
             }
 
-            actions.emplace_back(ProductionDistribution{stored_goods[0], stored_goods[1], stored_goods[2], stored_goods[3], stored_goods[4], 0}, is_captain);
+            sink(Action(ProductionDistribution{stored_goods[0], stored_goods[1], stored_goods[2], stored_goods[3], stored_goods[4], 0}, is_captain));
         }
     }
+}
 
-    return actions;
-}
\ No newline at end of file
+template void CaptainAction::perform<NullLog>(GameState& g, const Action& action) const;
+template void CaptainAction::perform<ConsoleLog>(GameState& g, const Action& action) const;
+template class ActionGenerator<CaptainAction>;
@@ -128,7 +128,7 @@ Action ConsoleStrategy::choose_builder_action(GameState& game, const std::vector
     int i = 0;
     for (const auto& action : actions) {
         i++;
-        std::cout << i << ": " << action.building.name() << " (" << action.building_cost << " doubloons)" << std::endl;
+        std::cout << i << ": " << action.building.name() << " (" << int(action.building_cost) << " doubloons)" << std::endl;
         // TODO: add building descriptions
     }
 
@@ -155,7 +155,7 @@ Action ConsoleStrategy::choose_trader_action(GameState& game, const std::vector<
     int i = 0;
     for (const auto& action : actions) {
         i++;
-        std::cout << i << ": " << good_name(action.good) << " (" << action.sell_price << " doubloons)" << std::endl;
+        std::cout << i << ": " << good_name(action.good) << " (" << int(action.sell_price) << " doubloons)" << std::endl;
     }
 
     int good_idx = get_user_choice(&game, actions.size(), "good", "sell");
@@ -171,7 +171,7 @@ Action ConsoleStrategy::choose_captain_action(GameState& game, const std::vector
     int i = 0;
     for (const auto& action : actions) {
         i++;
-        std::cout << i << ": " << good_name(action.good) << " on ship with capacity: " << action.ship_capacity << std::endl;
+        std::cout << i << ": " << good_name(action.good) << " on ship with capacity: " << int(action.ship_capacity) << std::endl;
     }
 
     int good_idx = get_user_choice(&game, actions.size(), "Good and Ship", "load");
@@ -264,7 +264,7 @@ Action ConsoleStrategy::mayor_action_from_player(const PlayerState& player) cons
 
     for (const auto& building : player.buildings) {
         if (building.colonists > 0 && building.building.good_produced() == Good::NONE)
-            alloc.buildings.push_back(building.building.type); // non-producing building
+            alloc.buildings.insert(building.building.type); // non-producing building
         if (building.building.good_produced() != Good::NONE)
             building_colonists[static_cast<int>(building.building.good_produced())] += building.colonists;
     }
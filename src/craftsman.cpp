@@ -1,8 +1,10 @@
 #include "craftsman.h"
 #include "game.h"
+#include "action_sink.h"
 
 #include <iostream>
 
+template <typename Log>
 void CraftsmanAction::perform(GameState& g, const Action& action) const {
     auto& player = g.player_state[g.current_player_idx];
 
@@ -22,8 +24,8 @@ void CraftsmanAction::perform(GameState& g, const Action& action) const {
             }
         }
 
-        if (g.verbose)
-            std::cout << "Player " << pidx << " got: ";
+        if constexpr (Log::enabled)
+            Log::out() << "Player " << pidx << " got: ";
 
         int factory_doubloons = 0;
 
@@ -31,60 +33,65 @@ void CraftsmanAction::perform(GameState& g, const Action& action) const {
             int gidx = static_cast<int>(produces.good);
             int production_count = std::min(produces.count, g.good_supply[gidx]);
 
-            if (g.verbose)
-                std::cout << production_count << " " << good_name(produces.good) << ", ";
+            if constexpr (Log::enabled)
+                Log::out() << production_count << " " << good_name(produces.good) << ", ";
             
-            player.goods[gidx] += production_count;
-            g.good_supply[gidx] -= production_count;
+            g.add(player.goods[gidx], production_count);
+            g.add(g.good_supply[gidx], -production_count);
             if (production_count > 0 && has_factory)
                 factory_doubloons += 1;
         }
-        if (g.verbose)
-            std::cout << std::endl;
+        if constexpr (Log::enabled)
+            Log::out() << '\n';
 
         if (has_factory && factory_doubloons > 1) {
-            player.doubloons += factory_doubloons - 1;
-            if (g.verbose)
-                std::cout << "Player " << pidx << " got " << factory_doubloons - 1 << " extra doubloons (Factory)" << std::endl;
+            g.add(player.doubloons, factory_doubloons - 1);
+            if constexpr (Log::enabled)
+                Log::out() << "Player " << pidx << " got " << factory_doubloons - 1 << " extra doubloons (Factory)" << '\n';
         }
     }
 
     if (action.good != Good::NONE) {
         int gidx = static_cast<int>(action.good);
         int bonus_production_count = std::min(1, g.good_supply[gidx]);
-        player.goods[gidx] += bonus_production_count;
-        g.good_supply[gidx] -= bonus_production_count;
+        g.add(player.goods[gidx], bonus_production_count);
+        g.add(g.good_supply[gidx], -bonus_production_count);
 
-        if (g.verbose && bonus_production_count > 0)
-            std::cout << "Player " << player.idx << " got a bonus 1 " << good_name(action.good) << std::endl;
+        if constexpr (Log::enabled) {
+            if (bonus_production_count > 0)
+                Log::out() << "Player " << player.idx << " got a bonus 1 " << good_name(action.good) << '\n';
+        }
     }
 
-    if (g.verbose)
-        std::cout << std::endl;
+    if constexpr (Log::enabled)
+        Log::out() << '\n';
 
-    g.next_round();
+    g.next_round<Log>();
 }
 
-std::vector<Action> CraftsmanAction::get_legal_actions(const GameState& g, bool is_craftsman) const {
-    std::vector<Action> actions;
-
+template <typename Sink>
+void CraftsmanAction::generate_actions(const GameState& g, bool is_craftsman, Sink& sink) const {
     if (!is_craftsman)
         throw std::runtime_error("Only the Craftsman can perform Craftsman actions");
 
     const auto& player = g.player_state[g.current_player_idx];
 
-    std::vector<GoodSupply> producing = player.get_producing_goods();
+    auto producing = player.get_producing_goods();
+    bool can_produce = false;
 
     // TODO: Current implementation might attempt to take a bonus Good that will not be available - we could deny this in advance if we wanted to
     for (const auto& good : producing) {
         if (good.count > 0) {
-            actions.emplace_back(good.good);
+            sink(Action(good.good));
+            can_produce = true;
         }
     }
 
-    if (actions.empty()) {
-        actions.emplace_back(Good::NONE);
+    if (!can_produce) {
+        sink(Action(Good::NONE));
     }
+}
 
-    return actions;
-}
\ No newline at end of file
+template void CraftsmanAction::perform<NullLog>(GameState& g, const Action& action) const;
+template void CraftsmanAction::perform<ConsoleLog>(GameState& g, const Action& action) const;
+template class ActionGenerator<CraftsmanAction>;
@@ -14,6 +14,7 @@ bool GameStateIntegrityChecker::check_integrity() const {
         check_building_count();
         check_plantation_count();
         check_victory_points();
+        check_hash();
     } catch (const std::runtime_error& e) {
         throw std::runtime_error("Integrity check failed: " + std::string(e.what()));
     }
@@ -110,15 +111,17 @@ void GameStateIntegrityChecker::check_plantation_count() const {
         }
     }
 
-    all_plantations.insert(all_plantations.end(), g.plantation_supply.begin(), g.plantation_supply.end());
     all_plantations.insert(all_plantations.end(), g.plantation_offer.begin(), g.plantation_offer.end());
-    all_plantations.insert(all_plantations.end(), g.plantation_discard.begin(), g.plantation_discard.end());
 
     for (const auto& plantation : all_plantations) {
         int plidx = static_cast<int>(plantation);
         plantations[plidx]--;
     }
 
+    for (int i = 0; i < 5; i++) {
+        plantations[i] -= g.plantation_supply[i] + g.plantation_discard[i];
+    }
+
     plantations[5] -= g.quarry_supply;
 
     for (int i = 0; i < 5; i++) {
@@ -135,4 +138,10 @@ void GameStateIntegrityChecker::check_victory_points() const {
 
     if (vps != g.victory_points_supply)
         throw std::runtime_error("Victory points count is incorrect");
+}
+
+void GameStateIntegrityChecker::check_hash() const {
+    // the incrementally updated Zobrist hash must match a full recompute
+    if (g.hash != g.compute_hash())
+        throw std::runtime_error("Incremental state hash does not match the recomputed hash");
 }
\ No newline at end of file
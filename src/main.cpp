@@ -1,5 +1,12 @@
 #include <iostream>
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <string>
 
 #include "game.h"
 #include "player.h"
@@ -35,7 +42,7 @@ std::vector<int> run_game(std::vector<Strategy*>& strategy, bool verbose = false
         if (game.is_game_over()) {
             if (verbose)
                 game.print_all();
-            return game.player_placements;
+            return std::vector<int>(game.player_placements.begin(), game.player_placements.end());
         }
     }
 }
@@ -44,8 +51,9 @@ std::vector<int> run_random_game(int player_count, Strategy* my_strategy = new R
     std::vector<Strategy*> strategies;
     strategies.reserve(player_count);
     strategies.push_back(my_strategy);
+    Rng seeder(seed);
     for (int i = 0; i < player_count - 1; i++)
-        strategies.push_back(new RandomStrategy());
+        strategies.push_back(new RandomStrategy(seeder())); // opponents are reproducible from the game seed
 
     return run_game(strategies, verbose, seed);
 }
@@ -58,6 +66,49 @@ void stress_test_integrity() {
     std::cout << "Integrity stress test passed" << std::endl;
 }
 
+void test_undo_action() {
+    // Property: for every legal Action in every reached state, perform_action() followed by undo_action() is a no-op
+    for (int i = 0; i < 200; i++) {
+        int player_count = rand() % 3 + 3; // 3, 4, 5
+        GameState game(player_count, false, rand());
+        RandomStrategy random_strategy(rand());
+
+        while (!game.is_game_over()) {
+            for (const auto& action : game.get_legal_actions()) {
+                GameState before = game;
+                UndoRecord undo = game.perform_action<NullLog>(action);
+                game.undo_action(undo);
+
+                if (game != before)
+                    throw std::runtime_error("undo_action() did not restore the state after a " + role_name(action.type) + " action");
+            }
+            random_strategy.make_move(game);
+        }
+    }
+    std::cout << "Undo property test passed" << std::endl;
+}
+
+void test_legal_action_sampling() {
+    // Property: count_legal_actions() and nth_legal_action() agree with the list get_legal_actions() generates
+    for (int i = 0; i < 200; i++) {
+        int player_count = rand() % 3 + 3; // 3, 4, 5
+        GameState game(player_count, false, rand());
+        RandomStrategy random_strategy(rand());
+
+        while (!game.is_game_over()) {
+            auto actions = game.get_legal_actions();
+            if (game.count_legal_actions() != int(actions.size()))
+                throw std::runtime_error("count_legal_actions() differs from the number of legal actions");
+            for (std::size_t k = 0; k < actions.size(); k++) {
+                if (!(game.nth_legal_action(k) == actions[k]))
+                    throw std::runtime_error("nth_legal_action() differs from get_legal_actions() for a " + role_name(actions[k].type) + " action");
+            }
+            random_strategy.make_move(game);
+        }
+    }
+    std::cout << "Legal action sampling test passed" << std::endl;
+}
+
 void measure_winrate() {
     std::chrono::time_point<std::chrono::system_clock> start, end;
     start = std::chrono::system_clock::now();
@@ -94,6 +145,505 @@ void measure_winrate() {
     std::cout << "Time: " << millis / 1000.0 << "s" << std::endl;
 }
 
+// Plays the game out with strategy at seat timed_idx and opponents made by make_opponent() at the other seats,
+// calling on_move(milliseconds) after each move of strategy. The opponents are deleted afterwards, strategy is not.
+template <typename OnMove>
+void play_timed_game(GameState& game, Strategy& strategy, int timed_idx, const std::function<Strategy*()>& make_opponent,
+                     OnMove on_move) {
+    std::vector<std::unique_ptr<Strategy>> opponents;
+    std::vector<Strategy*> seats;
+    for (int i = 0; i < game.player_count; i++) {
+        if (i == timed_idx) {
+            seats.push_back(&strategy);
+        } else {
+            opponents.emplace_back(make_opponent());
+            seats.push_back(opponents.back().get());
+        }
+    }
+
+    while (!game.is_game_over()) {
+        int player_idx = game.get_current_player_idx();
+        auto start = std::chrono::steady_clock::now();
+        seats[player_idx]->make_move(game);
+        if (player_idx == timed_idx)
+            on_move(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+}
+
+void benchmark_maxn() {
+    // Per-move latency of MaxnStrategy(5) against RandomStrategies, without and with its transposition table
+    for (std::size_t table_size : {std::size_t(0), std::size_t(1 << 16)}) {
+        srand(0);
+        double total_millis = 0;
+        int move_count = 0;
+        std::uint64_t probes = 0, hits = 0;
+
+        for (int i = 0; i < 5; i++) {
+            int player_count = rand() % 3 + 3; // 3, 4, 5
+            GameState game(player_count, false, rand());
+            MaxnStrategy maxn(5, table_size);
+            play_timed_game(game, maxn, 0, [] { return new RandomStrategy(rand()); }, [&](double millis) {
+                total_millis += millis;
+                move_count++;
+            });
+
+            probes += maxn.transposition_table().probe_count();
+            hits += maxn.transposition_table().hit_count();
+        }
+
+        std::cout << "Transposition table size " << table_size << ": " << total_millis / move_count << "ms per move, "
+            << "hit rate " << (probes == 0 ? 0.0 : 100.0 * hits / probes) << "%" << std::endl;
+    }
+}
+
+void benchmark_mcts() {
+    // Per-move latency and search tree size of MCTSStrategy(1000) against RandomStrategies
+    srand(0);
+    double total_millis = 0;
+    std::size_t total_tree_bytes = 0, peak_tree_bytes = 0;
+    long long reused_visits = 0;
+    int move_count = 0;
+
+    for (int i = 0; i < 3; i++) {
+        GameState game(4, false, rand());
+        MCTSStrategy mcts(1000);
+        play_timed_game(game, mcts, 0, [] { return new RandomStrategy(rand()); }, [&](double millis) {
+            total_millis += millis;
+            total_tree_bytes += mcts.tree_bytes();
+            move_count++;
+        });
+
+        peak_tree_bytes = std::max(peak_tree_bytes, mcts.peak_tree_bytes());
+        reused_visits += mcts.total_reused_visits();
+    }
+    std::cout << "MCTS: " << total_millis / move_count << "ms per move, tree size " << total_tree_bytes / move_count / 1024
+        << " KB per move on average, " << peak_tree_bytes / 1024 << " KB at peak, "
+        << reused_visits / move_count << " visits reused per move" << std::endl;
+}
+
+// One side of a head_to_head() match
+struct MatchSide {
+    int wins = 0; // games it placed ahead of the other side
+    int firsts = 0; // games it won outright
+    int placement_sum = 0; // 1-based, for the average placement
+    int moves = 0;
+    double millis = 0;
+    long long iterations = 0;
+    long long iterations_saved = 0;
+
+    // e.g. "21/40 games (4.4ms, 407 iterations per move)"
+    std::string summary(int game_count) const {
+        std::ostringstream out;
+        out << wins << "/" << game_count << " games (" << millis / moves << "ms";
+        if (iterations > 0)
+            out << ", " << iterations / moves << " iterations";
+        if (iterations_saved > 0)
+            out << ", " << iterations_saved / moves << " saved";
+        out << " per move)";
+        return out.str();
+    }
+};
+
+using StrategyFactory = std::function<Strategy*(std::uint64_t seed)>;
+
+// The strategies made by make_a and make_b play game_count 3-player games against each other and a third player
+// made by make_third, swapping seats every game. Iterations are only counted for MCTSStrategies
+std::array<MatchSide, 2> head_to_head(const StrategyFactory& make_a, const StrategyFactory& make_b, int game_count,
+                                      const std::function<Strategy*(int game_idx)>& make_third =
+                                          [](int) -> Strategy* { return new SimpleHeuristicStrategy(); }) {
+    std::array<MatchSide, 2> sides;
+    for (int i = 0; i < game_count; i++) {
+        int a_idx = i % 2; // alternate seats
+        GameState game(3, false, i);
+        std::vector<Player> players;
+        players.reserve(3);
+        MCTSStrategy* mcts[2];
+        for (int j = 0; j < 2; j++) {
+            Strategy* strategy = j == a_idx ? make_a(i * 2 + j) : make_b(i * 2 + j);
+            mcts[j] = dynamic_cast<MCTSStrategy*>(strategy);
+            players.emplace_back(game, strategy);
+        }
+        players.emplace_back(game, make_third(i));
+
+        while (!game.is_game_over()) {
+            int player_idx = game.get_current_player_idx();
+            auto start = std::chrono::steady_clock::now();
+            players[player_idx].make_move();
+            if (player_idx < 2) {
+                MatchSide& side = sides[player_idx == a_idx ? 0 : 1];
+                side.millis += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                if (mcts[player_idx]) {
+                    side.iterations += mcts[player_idx]->iterations_reached();
+                    side.iterations_saved += mcts[player_idx]->iterations_saved();
+                }
+                side.moves++;
+            }
+        }
+
+        sides[game.player_placements[a_idx] < game.player_placements[1 - a_idx] ? 0 : 1].wins++;
+        for (int j = 0; j < 2; j++) {
+            MatchSide& side = sides[j == a_idx ? 0 : 1];
+            side.firsts += game.player_placements[j] == 0;
+            side.placement_sum += game.player_placements[j] + 1;
+        }
+    }
+    return sides;
+}
+
+void compare_mcts_tree_reuse() {
+    // MCTSStrategy with and without tree reuse at the same iteration budget, playing each other (plus a RandomStrategy)
+    int game_count = 20;
+    auto results = head_to_head(
+        [](std::uint64_t seed) { return new MCTSStrategy(300, true, 1, seed); },
+        [](std::uint64_t seed) { return new MCTSStrategy(300, false, 1, seed); },
+        game_count, [](int game_idx) -> Strategy* { return new RandomStrategy(game_idx); });
+
+    std::cout << "MCTS with tree reuse placed ahead in " << results[0].summary(game_count)
+        << ", without in " << results[1].summary(game_count) << std::endl;
+}
+
+void compare_progressive_widening() {
+    // MCTSStrategy(500) with UCT, with and without progressive widening, playing each other (plus a RandomStrategy)
+    int game_count = 40;
+    auto results = head_to_head(
+        [](std::uint64_t seed) {
+            auto* mcts = new MCTSStrategy(500, true, 1, seed);
+            mcts->settings.puct_weight = 0;
+            mcts->settings.widening_k = 1;
+            return mcts;
+        },
+        [](std::uint64_t seed) {
+            auto* mcts = new MCTSStrategy(500, true, 1, seed);
+            mcts->settings.puct_weight = 0;
+            return mcts;
+        },
+        game_count, [](int game_idx) -> Strategy* { return new RandomStrategy(game_idx); });
+
+    std::cout << "MCTS with progressive widening placed ahead in " << results[0].summary(game_count)
+        << ", without in " << results[1].summary(game_count) << std::endl;
+}
+
+void measure_mcts_winrate() {
+    // Winrate and average placement of MCTSStrategy(500) against two MaxnStrategy(5) and against two SimpleHeuristicStrategies,
+    // rewarding playouts by win/loss and by placement
+    int game_count = 90;
+    for (bool placement_rewards : {false, true}) {
+        for (bool maxn_opponents : {true, false}) {
+            auto make_opponent = [maxn_opponents]() -> Strategy* {
+                if (maxn_opponents)
+                    return new MaxnStrategy(5);
+                return new SimpleHeuristicStrategy();
+            };
+            auto results = head_to_head(
+                [placement_rewards](std::uint64_t seed) {
+                    auto* mcts = new MCTSStrategy(500, true, 1, seed);
+                    mcts->settings.placement_rewards = placement_rewards;
+                    return mcts;
+                },
+                [&](std::uint64_t) { return make_opponent(); }, game_count, [&](int) { return make_opponent(); });
+
+            std::cout << "MCTS with " << (placement_rewards ? "placement" : "win/loss") << " rewards vs. "
+                << (maxn_opponents ? "MaxnStrategy(5)" : "SimpleHeuristicStrategy") << ": winrate "
+                << 100.0 * results[0].firsts / game_count << "%, average placement "
+                << double(results[0].placement_sum) / game_count << std::endl;
+        }
+    }
+}
+
+void compare_truncated_rollouts() {
+    // MCTSStrategy(10ms per move) with rollouts truncated at the end of the round and with full rollouts,
+    // playing each other (plus a SimpleHeuristicStrategy)
+    int game_count = 40;
+    auto results = head_to_head(
+        [](std::uint64_t seed) {
+            auto* mcts = new MCTSStrategy(std::chrono::milliseconds(10), true, 1, seed);
+            mcts->settings.rollout_rounds = 1;
+            return mcts;
+        },
+        [](std::uint64_t seed) { return new MCTSStrategy(std::chrono::milliseconds(10), true, 1, seed); },
+        game_count);
+
+    std::cout << "MCTS with truncated rollouts placed ahead in " << results[0].summary(game_count)
+        << ", with full rollouts in " << results[1].summary(game_count) << std::endl;
+}
+
+void compare_playout_policies() {
+    // MCTSStrategy(10ms per move) with EpsilonGreedyPlayout and with RandomPlayout rollouts,
+    // playing each other (plus a SimpleHeuristicStrategy)
+    int game_count = 40;
+    auto results = head_to_head(
+        [](std::uint64_t seed) {
+            auto* mcts = new MCTSStrategy(std::chrono::milliseconds(10), true, 1, seed);
+            mcts->set_playout_policy([](Rng rng) { return std::make_unique<EpsilonGreedyPlayout>(rng); });
+            return mcts;
+        },
+        [](std::uint64_t seed) { return new MCTSStrategy(std::chrono::milliseconds(10), true, 1, seed); },
+        game_count);
+
+    std::cout << "MCTS with epsilon-greedy playouts placed ahead in " << results[0].summary(game_count)
+        << ", with random playouts in " << results[1].summary(game_count) << std::endl;
+}
+
+void compare_puct() {
+    // MCTSStrategy(300) with PUCT against MCTSStrategy(1000) with UCT and progressive widening,
+    // playing each other (plus a SimpleHeuristicStrategy)
+    int game_count = 60;
+    auto results = head_to_head(
+        [](std::uint64_t seed) { return new MCTSStrategy(300, true, 1, seed); },
+        [](std::uint64_t seed) {
+            auto* mcts = new MCTSStrategy(1000, true, 1, seed);
+            mcts->settings.puct_weight = 0;
+            mcts->settings.widening_k = 1;
+            return mcts;
+        },
+        game_count);
+
+    std::cout << "MCTS(300) with PUCT placed ahead in " << results[0].summary(game_count)
+        << ", MCTS(1000) with UCT in " << results[1].summary(game_count) << std::endl;
+}
+
+void benchmark_early_stop() {
+    // MCTSStrategy(1000) with early stopping against one without, playing each other (plus a SimpleHeuristicStrategy)
+    int game_count = 40;
+    auto results = head_to_head(
+        [](std::uint64_t seed) { return new MCTSStrategy(1000, true, 1, seed); },
+        [](std::uint64_t seed) {
+            auto* mcts = new MCTSStrategy(1000, true, 1, seed);
+            mcts->settings.early_stop_interval = 0;
+            return mcts;
+        },
+        game_count);
+
+    std::cout << "MCTS(1000) with early stopping placed ahead in " << results[0].summary(game_count)
+        << ", without in " << results[1].summary(game_count) << std::endl;
+}
+
+void benchmark_rave() {
+    // Winrate of MCTSStrategy against two SimpleHeuristicStrategies by iterations per move and RAVE equivalence (0 is off),
+    // to see how many iterations RAVE saves for the same strength
+    int game_count = 30;
+    for (int iterations : {100, 250, 500, 1000}) {
+        for (double rave_equivalence : {0.0, 10.0, 50.0}) {
+            auto results = head_to_head(
+                [=](std::uint64_t seed) {
+                    auto* mcts = new MCTSStrategy(iterations, true, 1, seed);
+                    mcts->settings.rave_equivalence = rave_equivalence;
+                    return mcts;
+                },
+                [](std::uint64_t) { return new SimpleHeuristicStrategy(); }, game_count);
+
+            std::cout << "MCTS(" << iterations << "), RAVE equivalence " << rave_equivalence << ": winrate "
+                << 100.0 * results[0].firsts / game_count << "%" << std::endl;
+        }
+    }
+}
+
+std::uint64_t play_parallel_mcts_game(int threads, std::uint64_t mcts_seed, int game_seed) {
+    // Returns the hash of the final position of MCTSStrategy(100) against two RandomStrategies
+    GameState game(3, false, game_seed);
+    std::vector<Player> players;
+    players.reserve(3);
+    players.emplace_back(game, new MCTSStrategy(100, true, threads, mcts_seed));
+    for (int j = 1; j < 3; j++)
+        players.emplace_back(game, new RandomStrategy(game_seed + j));
+
+    while (!game.is_game_over())
+        players[game.get_current_player_idx()].make_move();
+    return game.hash;
+}
+
+void stress_test_parallel_mcts() {
+    // Tree-parallel MCTS with more threads than cores, checking the shared tree after every move.
+    // Build with -DSANITIZE_THREADS=ON to have ThreadSanitizer report any data race on the way.
+    for (int i = 0; i < 10; i++) {
+        int player_count = rand() % 3 + 3; // 3, 4, 5
+        GameState game(player_count, false, rand());
+        auto* mcts = new MCTSStrategy(50, true, 8, rand(), MCTSParallelism::TREE);
+        std::vector<Player> players;
+        players.reserve(player_count);
+        players.emplace_back(game, mcts);
+        for (int j = 1; j < player_count; j++)
+            players.emplace_back(game, new RandomStrategy(rand()));
+
+        while (!game.is_game_over()) {
+            int player_idx = game.get_current_player_idx();
+            players[player_idx].make_move();
+            if (player_idx == 0)
+                mcts->check_integrity();
+            game.check_integrity();
+        }
+    }
+    std::cout << "Parallel MCTS stress test passed" << std::endl;
+}
+
+void benchmark_parallel_mcts() {
+    // Root- and tree-parallel MCTSStrategy(200 iterations per thread) against two SimpleHeuristicStrategies, for 1 to 16 threads.
+    // Reports the latency per move, the search throughput per thread and the winrate.
+    bool deterministic = play_parallel_mcts_game(4, 42, 7) == play_parallel_mcts_game(4, 42, 7);
+    std::cout << "Root-parallel MCTS is " << (deterministic ? "" : "NOT ") << "deterministic for a fixed seed and thread count" << std::endl;
+
+    int game_count = 10;
+    for (auto parallelism : {MCTSParallelism::ROOT, MCTSParallelism::TREE}) {
+        for (int threads : {1, 2, 4, 8, 16}) {
+            double total_millis = 0;
+            long long total_iterations = 0;
+            int move_count = 0;
+            int win_count = 0;
+
+            for (int i = 0; i < game_count; i++) {
+                GameState game(3, false, i);
+                int mcts_idx = i % 3;
+                MCTSStrategy mcts(200, true, threads, i, parallelism);
+                play_timed_game(game, mcts, mcts_idx, [] { return new SimpleHeuristicStrategy(); }, [&](double millis) {
+                    total_millis += millis;
+                    total_iterations += mcts.iterations_reached(); // searches may stop before using up the budget
+                    move_count++;
+                });
+                if (game.player_placements[mcts_idx] == 0)
+                    win_count++;
+            }
+
+            std::cout << (parallelism == MCTSParallelism::ROOT ? "Root" : "Tree") << ", " << threads << " threads: "
+                << total_millis / move_count << "ms per move, "
+                << double(total_iterations) / threads / total_millis << "k iterations/s per thread, winrate "
+                << 100.0 * win_count / game_count << "%" << std::endl;
+        }
+    }
+}
+
+void benchmark_time_budget() {
+    // Move latency of fixed-work and time-budgeted MCTS and maxn against RandomStrategies,
+    // with the mean number of iterations or search depth the time-budgeted ones reach
+    auto measure = [](const std::string& name, auto make_strategy, auto reached) {
+        srand(0);
+        std::vector<double> millis;
+        double total_reached = 0;
+
+        for (int i = 0; i < 3; i++) {
+            GameState game(4, false, rand());
+            auto strategy = make_strategy();
+            play_timed_game(game, *strategy, 0, [] { return new RandomStrategy(rand()); }, [&](double move_millis) {
+                millis.push_back(move_millis);
+                total_reached += reached(*strategy);
+            });
+        }
+
+        std::sort(millis.begin(), millis.end());
+        double mean = std::accumulate(millis.begin(), millis.end(), 0.0) / millis.size();
+        std::cout << name << ": " << mean << "ms mean, " << millis[millis.size() * 99 / 100] << "ms p99, "
+            << millis.back() << "ms max per move, reached " << total_reached / millis.size() << " on average" << std::endl;
+    };
+
+    auto mcts_iterations = [](const MCTSStrategy& mcts) { return mcts.iterations_reached(); };
+    auto maxn_depth = [](const MaxnStrategy& maxn) { return maxn.depth_reached(); };
+    measure("MCTS(1000 iterations)", [] { return std::make_unique<MCTSStrategy>(1000); }, mcts_iterations);
+    measure("MCTS(20ms)", [] { return std::make_unique<MCTSStrategy>(std::chrono::milliseconds(20)); }, mcts_iterations);
+    measure("Maxn(depth 3)", [] { return std::make_unique<MaxnStrategy>(3); }, maxn_depth);
+    measure("Maxn(20ms)", [] { return std::make_unique<MaxnStrategy>(std::chrono::milliseconds(20)); }, maxn_depth);
+}
+
+// The if-chain GameState::perform_action() dispatched through before the RoleHandlers table, kept as a benchmark baseline
+void legacy_perform(GameState& game, const Action& action) {
+    if (action.type == PlayerRole::PROSPECTOR)
+        ProspectorAction().perform<NullLog>(game, action);
+    else if (action.type == PlayerRole::PROSPECTOR_2)
+        Prospector2Action().perform<NullLog>(game, action);
+    else if (action.type == PlayerRole::CRAFTSMAN)
+        CraftsmanAction().perform<NullLog>(game, action);
+    else if (action.type == PlayerRole::BUILDER)
+        BuilderAction().perform<NullLog>(game, action);
+    else if (action.type == PlayerRole::SETTLER)
+        SettlerAction().perform<NullLog>(game, action);
+    else if (action.type == PlayerRole::TRADER)
+        TraderAction().perform<NullLog>(game, action);
+    else if (action.type == PlayerRole::MAYOR)
+        MayorAction().perform<NullLog>(game, action);
+    else if (action.type == PlayerRole::CAPTAIN)
+        CaptainAction().perform<NullLog>(game, action);
+}
+
+void benchmark_dispatch() {
+    // Replays the moves of random games on a scratch copy of each position, dispatching through the if-chain and the table.
+    // Both loops do the same copy and Role work, so the difference between them is the dispatch cost per move.
+    std::vector<std::pair<GameState, Action>> moves;
+    for (int i = 0; i < 20; i++) {
+        GameState game(i % 3 + 3, false, i);
+        Rng rng(i);
+        while (!game.is_game_over()) {
+            auto actions = game.get_legal_actions();
+            Action action = actions[rng() % actions.size()];
+            moves.emplace_back(game, action);
+            game.perform_action(action);
+        }
+    }
+
+    auto measure = [&moves](void (*dispatch)(GameState&, const Action&)) {
+        auto start = std::chrono::steady_clock::now();
+        for (int repeat = 0; repeat < 50; repeat++) {
+            for (const auto& [state, action] : moves) {
+                GameState scratch = state;
+                dispatch(scratch, action);
+            }
+        }
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (50 * moves.size());
+    };
+
+    double chain = measure(legacy_perform);
+    double table = measure([](GameState& game, const Action& action) { role_handler(action.type).perform(game, action); });
+    std::cout << moves.size() << " moves: if-chain " << chain << "ns per move, dispatch table " << table << "ns per move" << std::endl;
+}
+
+// RandomStrategy::choose_action() before it only generated the picked Role's Actions, kept as a benchmark baseline
+Action legacy_random_action(const GameState& game, Rng& rng, MoveList& actions) {
+    actions.clear();
+    game.get_legal_actions(actions);
+
+    bool has_role[static_cast<int>(PlayerRole::NONE) + 1] = {};
+    for (const auto& action : actions)
+        has_role[static_cast<int>(action.type)] = true;
+    FixedVector<PlayerRole, static_cast<int>(PlayerRole::NONE) + 1> role_vector;
+    for (int i = 0; i <= static_cast<int>(PlayerRole::NONE); i++) {
+        if (has_role[i])
+            role_vector.push_back(static_cast<PlayerRole>(i));
+    }
+    PlayerRole role = role_vector[rng() % role_vector.size()];
+
+    actions.erase(std::remove_if(actions.begin(), actions.end(), [role](const Action& action) {
+        return action.type != role;
+    }), actions.end());
+    return actions[rng() % actions.size()];
+}
+
+void benchmark_rollouts() {
+    // Random games per second from fresh positions, through the old action choice and through RandomStrategy::play_out()
+    int game_count = 2000;
+    double legacy_millis, kernel_millis;
+
+    {
+        Rng rng(0);
+        MoveList actions;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < game_count; i++) {
+            GameState game(i % 3 + 3, false, i);
+            while (!game.is_game_over())
+                game.perform_action<NullLog, false>(legacy_random_action(game, rng, actions));
+        }
+        legacy_millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    {
+        RandomStrategy rollout(Rng(0));
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < game_count; i++) {
+            GameState game(i % 3 + 3, false, i);
+            rollout.play_out(game);
+        }
+        kernel_millis = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::cout << "Rollouts: legacy " << 1000.0 * game_count / legacy_millis << " games/s, play_out "
+        << 1000.0 * game_count / kernel_millis << " games/s" << std::endl;
+}
+
 void play_against_computer() {
     std::cout << "Choose player count:" << std::endl;
     for (int p = 3; p <= 5; p++) {
@@ -132,7 +682,7 @@ void play_against_computer() {
 
 int main() {
     auto seed = time(0);
-    //seed = 0; // Player scores should equal [20, 11, 16, 23] for seed 0 and all RandomStrategies
+    //seed = 0; // Player scores should equal [38, 22, 13, 23] for seed 0 and run_random_game(4, new RandomStrategy(0), false, seed)
     srand(seed);
     std::cout << "Seed: " << seed << std::endl;
 
@@ -143,8 +693,25 @@ int main() {
 
     // TODO: Make legit Tests
     //stress_test_integrity(); // Passing
+    //test_undo_action(); // Passing
+    //test_legal_action_sampling(); // Passing
+    //stress_test_parallel_mcts(); // Passing, also under ThreadSanitizer
 
     //measure_winrate();
+    //benchmark_maxn();
+    //benchmark_mcts();
+    //compare_mcts_tree_reuse();
+    //compare_progressive_widening();
+    //measure_mcts_winrate();
+    //benchmark_rave();
+    //compare_truncated_rollouts();
+    //compare_playout_policies();
+    //compare_puct();
+    //benchmark_early_stop();
+    //benchmark_parallel_mcts();
+    //benchmark_time_budget();
+    //benchmark_dispatch();
+    //benchmark_rollouts();
 
     return 0;
 }
@@ -3,37 +3,39 @@
 
 #include <iostream>
 
+template <typename Log>
 void MayorAction::perform(GameState& g, const Action& action) const {
     auto& player = g.player_state[g.current_player_idx];
 
     int took_from_supply = 0;
     if (player.idx == g.current_round_player_idx) {
-        std::fill(g.colonists_for_player, g.colonists_for_player + 5, 0);
-        g.colonists_for_player[player.idx] += g.colonist_supply > 0; // TODO: Mayor bonus could be refused, but we always accept it for now
+        for (auto& colonists : g.colonists_for_player)
+            g.set(colonists, 0);
+        g.add(g.colonists_for_player[player.idx], g.colonist_supply > 0); // TODO: Mayor bonus could be refused, but we always accept it for now
 
         for (int i = 0; i < g.colonist_ship; i++) {
-            g.colonists_for_player[(player.idx + i) % g.player_count] += 1;
+            g.add(g.colonists_for_player[(player.idx + i) % g.player_count], 1);
         }
 
         if (g.colonist_supply > 0) {
-            if (g.verbose)
-                std::cout << "Player " << player.idx << " took 1 extra Colonist from the supply" << std::endl;
+            if constexpr (Log::enabled)
+                Log::out() << "Player " << player.idx << " took 1 extra Colonist from the supply" << '\n';
             
             took_from_supply++;
         }
     }
 
     int took_from_ship = g.colonists_for_player[player.idx] - took_from_supply;
-    g.colonist_ship -= took_from_ship;
-    g.colonist_supply -= took_from_supply;
-    g.colonists_for_player[player.idx] = 0;
+    g.add(g.colonist_ship, -took_from_ship);
+    g.add(g.colonist_supply, -took_from_supply);
+    g.set(g.colonists_for_player[player.idx], 0);
 
     auto dist_plant = action.mayor_allocation.distribution;
     auto dist_build = action.mayor_allocation.distribution;
     int extras = action.mayor_allocation.extra_colonists;
 
-    std::vector<PlantationState> new_plantations;
-    std::vector<BuildingState> new_buildings;
+    FixedVector<PlantationState, 12> new_plantations;
+    FixedVector<BuildingState, 12> new_buildings;
 
     for (auto plantation : player.plantations) {
         int pidx = static_cast<int>(plantation.plantation);
@@ -61,14 +63,14 @@ void MayorAction::perform(GameState& g, const Action& action) const {
             int gidx = static_cast<int>(building.building.good_produced());
 
             if (dist_build.w[gidx] > 0) {
-                int num_cols = std::min(dist_build.w[gidx], building.building.capacity());
+                int num_cols = std::min<int>(dist_build.w[gidx], building.building.capacity());
                 building.colonists = num_cols;
                 dist_build.w[gidx] -= num_cols;
             }
             else {
                 building.colonists = 0;
             }
-        } else if (std::find(buildings.begin(), buildings.end(), building.building.type) != buildings.end()) {
+        } else if (buildings.contains(building.building.type)) {
             building.colonists = 1;
         } else {
             building.colonists = 0;
@@ -83,35 +85,99 @@ void MayorAction::perform(GameState& g, const Action& action) const {
         new_buildings.push_back(building);
     }
 
+    g.hash -= g.key(player.plantations) + g.key(player.buildings);
     player.plantations = new_plantations;
     player.buildings = new_buildings;
-    player.extra_colonists = extras;
+    g.hash += g.key(player.plantations) + g.key(player.buildings);
+    g.set(player.extra_colonists, extras);
 
-    if (g.verbose) {
-        std::cout << "Player " << player.idx << " distributed Colonists:" << std::endl;
+    if constexpr (Log::enabled) {
+        Log::out() << "Player " << player.idx << " distributed Colonists:" << '\n';
 
         // TODO: seperate into player.print_colonists()
 
-        std::cout << "Buildings: ";
+        Log::out() << "Buildings: ";
         for (const auto& building : player.buildings) {
-            std::cout << building.building.name() << " " << building.colonists << "/" << building.building.capacity() << ", ";
+            Log::out() << building.building.name() << " " << building.colonists << "/" << building.building.capacity() << ", ";
         }
-        std::cout << std::endl;
+        Log::out() << '\n';
 
-        std::cout << "Plantations: ";
+        Log::out() << "Plantations: ";
         for (const auto& plantation : player.plantations) {
-            std::cout << plantation_name(plantation) << " " << plantation.colonists << "/1, ";
+            Log::out() << plantation_name(plantation) << " " << plantation.colonists << "/1, ";
         }
-        std::cout << std::endl;
+        Log::out() << '\n';
 
         if (player.extra_colonists > 0)
-            std::cout << "Extra Colonists: " << player.extra_colonists << std::endl;
+            Log::out() << "Extra Colonists: " << player.extra_colonists << '\n';
     }
     
-    g.next_player();
+    g.next_player<Log>();
 }
 
-std::vector<Action> MayorAction::get_legal_actions(const GameState& g, bool is_mayor) const {
+namespace {
+
+constexpr std::size_t DISTRIBUTION_LIMIT = 100; // arbitrary limit
+
+// Everything the Mayor's legal Actions are derived from: the goods production distributions, and how many ways of
+// staffing the remaining non-production buildings are tried for each of them.
+// Every allocation chooses its buildings with its own random stream, keyed by its index in the list,
+// so any single allocation can be built without generating the ones before it.
+struct MayorOptions {
+    FixedVector<ProductionDistribution, DISTRIBUTION_LIMIT + 1> distributions;
+    FixedVector<BuildingType, 12> nonprod_buildings;
+    int total_colonists;
+    int max_allocs_per_dist;
+    std::uint64_t seed;
+
+    int total_building(const ProductionDistribution& dist) const {
+        int total_plantation = dist.corn() + 2 * dist.indigo() + 2 * dist.sugar() + 2 * dist.tobacco() + 2 * dist.coffee() + dist.querry();
+        return total_colonists - total_plantation;
+    }
+
+    int allocation_count(const ProductionDistribution& dist) const {
+        int building = total_building(dist);
+        if (nonprod_buildings.size() <= std::size_t(building) || building == 0) // result would always be the same, since we have more than enough people
+            return 1;
+        return max_allocs_per_dist;
+    }
+
+    Action allocation(const ProductionDistribution& dist, int idx) const {
+        int building = total_building(dist);
+        int total_extra = std::max(0, building - int(nonprod_buildings.size()));
+
+        // randomly choose the staffed buildings, with a partial Fisher-Yates shuffle
+        Rng rng(seed, idx);
+        auto buildings_copy = nonprod_buildings;
+        int staffed = std::min<int>(building, buildings_copy.size());
+        BuildingMask buildings;
+        for (int i = 0; i < staffed; i++) {
+            std::swap(buildings_copy[i], buildings_copy[i + rng() % (buildings_copy.size() - i)]);
+            buildings.insert(buildings_copy[i]);
+        }
+        return MayorAllocation(dist, buildings, total_extra);
+    }
+
+    int allocation_count() const {
+        int count = 0;
+        for (const auto& dist : distributions)
+            count += allocation_count(dist);
+        return count;
+    }
+
+    Action nth_allocation(int k) const {
+        int idx = 0;
+        for (const auto& dist : distributions) {
+            int count = allocation_count(dist);
+            if (k < idx + count)
+                return allocation(dist, k);
+            idx += count;
+        }
+        throw std::runtime_error("Legal Action index out of range");
+    }
+};
+
+MayorOptions mayor_options(const GameState& g, bool is_mayor) {
     // Brute-forcing all possible colonist allocations here would not be feasible.
     // (20 colonist slots with 12 total colonists would result in over 100k possibilities.)
     // Instead, we will generate up to 100 distributions of which goods to produce (also counting Quarries as a Good).
@@ -124,9 +190,8 @@ std::vector<Action> MayorAction::get_legal_actions(const GameState& g, bool is_m
 
     // TODO: implement an alternate, simple strategy that only allocates new Colonists without removing any previous ones
 
-    std::vector<Action> actions;
-
     auto& player = g.player_state[g.current_player_idx];
+    MayorOptions options;
 
     int colonists_for_player[5];
     if (is_mayor) {
@@ -143,8 +208,9 @@ std::vector<Action> MayorAction::get_legal_actions(const GameState& g, bool is_m
     }
 
     int total_colonists = player.get_total_colonists() + colonists_for_player[player.idx];
+    options.total_colonists = total_colonists;
     
-    std::vector<BuildingType> nonprod_buildings;
+    auto& nonprod_buildings = options.nonprod_buildings;
     for (const auto& building : player.buildings) {
         if (building.building.good_produced() == Good::NONE)
             nonprod_buildings.push_back(building.building.type);
@@ -154,8 +220,7 @@ std::vector<Action> MayorAction::get_legal_actions(const GameState& g, bool is_m
     int querries = player.get_querry_count(true);
     int max_employed = max_goods[0].count + 2 * max_goods[1].count + 2 * max_goods[2].count + 2 * max_goods[3].count + 2 * max_goods[4].count + querries;
 
-    std::size_t DISTRIBUTION_LIMIT = 100; // arbitrary limit
-    std::vector<ProductionDistribution> distributions;
+    auto& distributions = options.distributions;
 
     // TODO: try to write this in a more readable way
     for (int corn = max_goods[0].count; corn >= 0 ; corn--) {
@@ -194,7 +259,7 @@ std::vector<Action> MayorAction::get_legal_actions(const GameState& g, bool is_m
                             if (employed < max_employed && std::size_t(q_col) > nonprod_buildings.size() + 1)
                                 continue;
 
-                            distributions.push_back({corn, indigo, sugar, tobacco, coffee, querry});
+                            distributions.emplace_back(corn, indigo, sugar, tobacco, coffee, querry);
 
                             if (distributions.size() > DISTRIBUTION_LIMIT)
                                 goto out;
@@ -212,28 +277,39 @@ std::vector<Action> MayorAction::get_legal_actions(const GameState& g, bool is_m
         // shouldn't happen, recovery method: //distributions.push_back({0, 0, 0, 0, 0, 0});
     }
 
-    int max_allocs_per_dist = std::min(std::size_t(20), 2 * DISTRIBUTION_LIMIT / distributions.size()); // arbitrary limit
+    options.max_allocs_per_dist = std::min(std::size_t(20), 2 * DISTRIBUTION_LIMIT / distributions.size()); // arbitrary limit
 
-    auto rng = g.rng; // g.rng is const, therefore unusable for std::shuffle
+    auto rng = g.rng; // g.rng is const - copying it is just 16 bytes
+    options.seed = (std::uint64_t(rng()) << 32) | rng();
 
-    for (auto& dist : distributions) {
-        int total_plantation = dist.corn() + 2 * dist.indigo() + 2 * dist.sugar() + 2 * dist.tobacco() + 2 * dist.coffee() + dist.querry();
-        int total_building = total_colonists - total_plantation;
-        int total_extra = std::max(0, total_building - int(nonprod_buildings.size()));
-
-        for (int i = 0; i < max_allocs_per_dist; i++) {
-            auto buildings_copy = nonprod_buildings;
-            std::shuffle(buildings_copy.begin(), buildings_copy.end(), rng); // randomly choose remaining buildings
-            if (buildings_copy.size() > std::size_t(total_building))
-                buildings_copy.resize(total_building);
-            actions.emplace_back(MayorAllocation(dist, buildings_copy, total_extra));
-
-            if (nonprod_buildings.size() <= std::size_t(total_building) || total_building == 0) // result would always be the same, since we have more than enough people
-                break;
-        }
+    return options;
+}
+
+} // namespace
+
+void MayorAction::get_legal_actions(const GameState& g, MoveList& actions, bool is_mayor) const {
+    auto options = mayor_options(g, is_mayor);
+    int idx = 0;
+    for (const auto& dist : options.distributions) {
+        for (int i = options.allocation_count(dist); i > 0; i--)
+            actions.push_back(options.allocation(dist, idx++));
     }
 
     // TODO: could remove duplicates by sorting contents of each MayorAllocation. Not very important
+}
+
+int MayorAction::count_legal_actions(const GameState& g, bool is_mayor) const {
+    return mayor_options(g, is_mayor).allocation_count();
+}
+
+Action MayorAction::nth_legal_action(const GameState& g, int k, bool is_mayor) const {
+    return mayor_options(g, is_mayor).nth_allocation(k);
+}
+
+Action MayorAction::random_legal_action(const GameState& g, Rng& rng, bool is_mayor) const {
+    auto options = mayor_options(g, is_mayor);
+    return options.nth_allocation(rng() % options.allocation_count());
+}
 
-    return actions;
-}
\ No newline at end of file
+template void MayorAction::perform<NullLog>(GameState& g, const Action& action) const;
+template void MayorAction::perform<ConsoleLog>(GameState& g, const Action& action) const;
@@ -1,20 +1,27 @@
 #include "prospector.h"
 #include "game.h"
+#include "action_sink.h"
 
 #include <iostream>
 
+template <typename Log>
 void ProspectorAction::perform(GameState& g, const Action& action) const {
     auto& player = g.player_state[g.current_player_idx];
-    g.player_state[player.idx].doubloons += 1;
+    g.add(g.player_state[player.idx].doubloons, 1);
 
-    if (g.verbose)
-        std::cout << "Player " << player.idx << " got 1 doubloon" << std::endl;
-    g.next_round();
+    if constexpr (Log::enabled)
+        Log::out() << "Player " << player.idx << " got 1 doubloon" << '\n';
+    g.next_round<Log>();
 }
 
-std::vector<Action> ProspectorAction::get_legal_actions(const GameState& g, bool is_prospector) const {
+template <typename Sink>
+void ProspectorAction::generate_actions(const GameState& g, bool is_prospector, Sink& sink) const {
     if (!is_prospector)
         throw std::runtime_error("Only the Prospector can perform Prospector actions");
 
-    return {Action(role)};
-}
\ No newline at end of file
+    sink(Action(role));
+}
+
+template void ProspectorAction::perform<NullLog>(GameState& g, const Action& action) const;
+template void ProspectorAction::perform<ConsoleLog>(GameState& g, const Action& action) const;
+template class ActionGenerator<ProspectorAction>;
@@ -1,25 +1,25 @@
 #include "settler.h"
 #include "game.h"
+#include "action_sink.h"
 
 #include <iostream>
 
+template <typename Log>
 void SettlerAction::perform(GameState& g, const Action& action) const {
     auto& player = g.player_state[g.current_player_idx];
 
     if (action.building_cost > 0) { // Hacienda used
-        std::shuffle(g.plantation_supply.begin(), g.plantation_supply.end(), g.rng);
-        auto random_plantation = g.plantation_supply.back();
-        player.plantations.push_back({random_plantation, 0});
-        g.plantation_supply.pop_back();
+        auto random_plantation = g.draw_plantation();
+        g.push_back(player.plantations, {random_plantation, 0});
 
-        if (g.verbose)
-            std::cout << "Player " << player.idx << " randomly settled a " << plantation_name(random_plantation) << " tile from Hacienda" << std::endl;
+        if constexpr (Log::enabled)
+            Log::out() << "Player " << player.idx << " randomly settled a " << plantation_name(random_plantation) << " tile from Hacienda" << '\n';
 
-        g.hacienda_just_used = true;
+        g.set(g.hacienda_just_used, true);
         return; // purpesfully don't call next_player() - Hacienda allows for a second (normal) plantation choice
     }
 
-    g.hacienda_just_used = false;
+    g.set(g.hacienda_just_used, false);
 
     if (action.plantation != Plantation::NONE) {
         bool has_hospice = false;
@@ -34,42 +34,43 @@ void SettlerAction::perform(GameState& g, const Action& action) const {
 
         if (has_hospice) {
             if (g.colonist_supply > 0) {
-                g.colonist_supply -= 1;
+                g.add(g.colonist_supply, -1);
 
-                if (g.verbose)
-                    std::cout << "Player " << player.idx << " assigned a Colonist to their plantation from the supply because of Hospice" << std::endl;
+                if constexpr (Log::enabled)
+                    Log::out() << "Player " << player.idx << " assigned a Colonist to their plantation from the supply because of Hospice" << '\n';
             }
             else if (g.colonist_ship > 0) {
-                g.colonist_ship -= 1;
+                g.add(g.colonist_ship, -1);
 
-                if (g.verbose)
-                    std::cout << "Player " << player.idx << " assigned a Colonist to their plantation from the ship because of Hospice" << std::endl;
+                if constexpr (Log::enabled)
+                    Log::out() << "Player " << player.idx << " assigned a Colonist to their plantation from the ship because of Hospice" << '\n';
             }
             else 
                 has_hospice = false; // no extra Colonist available
         }
 
-        player.plantations.push_back({action.plantation, has_hospice});
+        g.push_back(player.plantations, {action.plantation, has_hospice});
 
         if (action.plantation == Plantation::QUARRY) {
-            g.quarry_supply--;
+            g.add(g.quarry_supply, -1);
         } else {
             auto pit = std::find(g.plantation_offer.begin(), g.plantation_offer.end(), action.plantation);
             if (pit == g.plantation_offer.end())
                 throw std::runtime_error("Chosen plantation not found among face-up plantation tiles");
+            g.hash -= g.key(g.plantation_offer);
             g.plantation_offer.erase(pit);
+            g.hash += g.key(g.plantation_offer);
         }
 
-        if (g.verbose)
-            std::cout << "Player " << player.idx << " settled a new " << plantation_name(action.plantation) << " tile " << std::endl;
+        if constexpr (Log::enabled)
+            Log::out() << "Player " << player.idx << " settled a new " << plantation_name(action.plantation) << " tile " << '\n';
     }
 
-    g.next_player();
+    g.next_player<Log>();
 }
 
-std::vector<Action> SettlerAction::get_legal_actions(const GameState& g, bool is_settler) const {
-    std::vector<Action> actions;
-
+template <typename Sink>
+void SettlerAction::generate_actions(const GameState& g, bool is_settler, Sink& sink) const {
     if (g.hacienda_just_used && g.current_player_idx == g.current_round_player_idx)
         is_settler = true;
 
@@ -78,29 +79,33 @@ std::vector<Action> SettlerAction::get_legal_actions(const GameState& g, bool is
     bool can_choose_quarry = is_settler || player.has(BuildingType::CONSTRUCTION_HUT);
     bool has_hacienda = player.has(BuildingType::HACIENDA);
 
-    if (g.plantation_supply.empty())
+    if (g.plantation_supply_count() == 0)
         has_hacienda = false; // can't use Hacienda if there are no plantations left
 
     int pcnt = player.plantations.size();
 
     if (has_hacienda && !g.hacienda_just_used && pcnt < 12) {
-        actions.emplace_back(Plantation::NONE, true); // use Hacienda
+        sink(Action(Plantation::NONE, true)); // use Hacienda
         if (pcnt < 11)
-            return actions; // always uses Hacienda first if there's at least 2 free spaces left
+            return; // always uses Hacienda first if there's at least 2 free spaces left
     }
 
     if (can_choose_quarry && g.quarry_supply > 0 && pcnt < 12)
-        actions.emplace_back(Plantation::QUARRY);
+        sink(Action(Plantation::QUARRY));
 
     // Remove duplicates to prune the search tree
-    std::set<Plantation> plantation_set(g.plantation_offer.begin(), g.plantation_offer.end());
+    bool offered[6] = {false, false, false, false, false, false};
+    for (auto plantation : g.plantation_offer)
+        offered[static_cast<int>(plantation)] = true;
 
-    for (const auto& plantation : plantation_set) {
-        if (pcnt < 12)
-            actions.emplace_back(plantation);
+    for (int i = 0; i < 6; i++) {
+        if (offered[i] && pcnt < 12)
+            sink(Action(static_cast<Plantation>(i)));
     }
 
-    actions.emplace_back(Plantation::NONE);
+    sink(Action(Plantation::NONE));
+}
 
-    return actions;
-}
\ No newline at end of file
+template void SettlerAction::perform<NullLog>(GameState& g, const Action& action) const;
+template void SettlerAction::perform<ConsoleLog>(GameState& g, const Action& action) const;
+template class ActionGenerator<SettlerAction>;
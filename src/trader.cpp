@@ -1,8 +1,10 @@
 #include "trader.h"
 #include "game.h"
+#include "action_sink.h"
 
 #include <iostream>
 
+template <typename Log>
 void TraderAction::perform(GameState& g, const Action& action) const {
     auto& player = g.player_state[g.current_player_idx];
 
@@ -10,34 +12,33 @@ void TraderAction::perform(GameState& g, const Action& action) const {
         int gidx = static_cast<int>(action.good);
         int sale_price = action.sell_price;
 
-        player.goods[gidx] -= 1;
-        player.doubloons += sale_price;
+        g.add(player.goods[gidx], -1);
+        g.add(player.doubloons, sale_price);
 
-        g.trading_house.push_back(action.good);
+        g.push_back(g.trading_house, action.good);
 
-        if (g.verbose) {
-            std::cout << "Player " << player.idx << " sold 1 " << good_name(action.good) << " for " << sale_price << " doubloons" << std::endl;
+        if constexpr (Log::enabled) {
+            Log::out() << "Player " << player.idx << " sold 1 " << good_name(action.good) << " for " << sale_price << " doubloons" << '\n';
 
-            std::cout << "Trading House now contains: ";
+            Log::out() << "Trading House now contains: ";
             for (const auto& good : g.trading_house) {
-                std::cout << good_name(good) << ", ";
+                Log::out() << good_name(good) << ", ";
             }
-            std::cout << std::endl;
+            Log::out() << '\n';
         }
     }
 
-    g.next_player();
+    g.next_player<Log>();
 }
 
-std::vector<Action> TraderAction::get_legal_actions(const GameState& g, bool is_trader) const {
-    std::vector<Action> actions;
-
+template <typename Sink>
+void TraderAction::generate_actions(const GameState& g, bool is_trader, Sink& sink) const {
     auto& player = g.player_state[g.current_player_idx];
 
-    actions.emplace_back(Good::NONE, 0); // sell nothing, but no bonus
+    sink(Action(Good::NONE, 0)); // sell nothing, but no bonus
 
     if (g.trading_house.size() == 4)
-        return actions;
+        return;
 
     bool good_allowed[5] = {true, true, true, true, true};
     bool has_office = player.has(BuildingType::OFFICE);
@@ -51,9 +52,11 @@ std::vector<Action> TraderAction::get_legal_actions(const GameState& g, bool is_
 
     for (int i = 0; i < 5; i++) {
         if (player.goods[i] > 0 && good_allowed[i]) {
-            actions.emplace_back(static_cast<Good>(i), i + sale_bonus); // i == price, 0/1/2/3/4 for Corn/Indigo/Sugar/Tobacco/Coffee
+            sink(Action(static_cast<Good>(i), i + sale_bonus)); // i == price, 0/1/2/3/4 for Corn/Indigo/Sugar/Tobacco/Coffee
         }
     }
+}
 
-    return actions;
-}
\ No newline at end of file
+template void TraderAction::perform<NullLog>(GameState& g, const Action& action) const;
+template void TraderAction::perform<ConsoleLog>(GameState& g, const Action& action) const;
+template class ActionGenerator<TraderAction>;